@@ -31,6 +31,12 @@ typedef struct {
     auth_state_t state;
 } auth_session_t;
 
+/* Set up the session allocator (before the first auth_session_create) */
+void auth_session_cache_init(void);
+
+/* Log its occupancy and release it once no session is left */
+void auth_session_cache_shutdown(void);
+
 /* Create auth session */
 auth_session_t *auth_session_create(client_t *client);
 
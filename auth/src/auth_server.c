@@ -26,12 +26,20 @@ static void auth_client_handler(client_t *client, void *userdata) {
 }
 
 result_t auth_server_start(void) {
+    auth_session_cache_init();
+
     g_auth_server = server_create(AUTH_SERVER_PORT, "AuthServer");
     if (!g_auth_server) {
+        auth_session_cache_shutdown();
         return ERR_MEMORY;
     }
 
-    return server_run(g_auth_server, auth_client_handler, NULL);
+    result_t result = server_run(g_auth_server, auth_client_handler, NULL);
+
+    /* Sessions are handled on the accept thread, so none are left */
+    auth_session_cache_shutdown();
+    database_thread_release();
+    return result;
 }
 
 void auth_server_stop(void) {
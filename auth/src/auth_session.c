@@ -8,6 +8,10 @@
 #include "auth.h"
 #include "packet.h"
 #include "opcodes.h"
+#include "slab.h"
+
+/* Sessions per slab */
+#define AUTH_SESSION_SLAB_OBJECTS 32
 
 /* WoW-specific N parameter (little-endian for protocol) */
 static const uint8_t N_BYTES_LE[] = {
@@ -17,14 +21,25 @@ static const uint8_t N_BYTES_LE[] = {
     0x5B, 0x53, 0xE1, 0x89, 0x5E, 0x64, 0x4B, 0x89
 };
 
+static slab_cache_t g_session_cache;
+
+void auth_session_cache_init(void) {
+    slab_cache_init(&g_session_cache, "auth_session_t", sizeof(auth_session_t), AUTH_SESSION_SLAB_OBJECTS);
+}
+
+void auth_session_cache_shutdown(void) {
+    slab_log_stats(&g_session_cache, "AuthServer");
+    slab_cache_destroy(&g_session_cache);
+}
+
 auth_session_t *auth_session_create(client_t *client) {
-    auth_session_t *session = ALLOC(auth_session_t);
+    auth_session_t *session = (auth_session_t*)slab_alloc(&g_session_cache);
     if (!session) return NULL;
 
     session->client = client;
     session->srp6 = srp6_create();
     if (!session->srp6) {
-        free(session);
+        slab_free(&g_session_cache, session);
         return NULL;
     }
 
@@ -38,7 +53,7 @@ void auth_session_free(auth_session_t *session) {
     if (!session) return;
     srp6_free(session->srp6);
     client_free(session->client);
-    free(session);
+    slab_free(&g_session_cache, session);
 }
 
 /* Handle AUTH_LOGON_CHALLENGE */
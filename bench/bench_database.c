@@ -0,0 +1,160 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * bench_database.c - Account and character lookup microbenchmark
+ *
+ * Compares the cached prepared statements against preparing the same SQL
+ * on every call, as database.c used to, then runs the cached lookups from
+ * several threads at once. Character lookups call the backend directly, since
+ * the character cache would answer them from memory; every lookup goes to
+ * the calling thread's reader connection.
+ *
+ * Usage: bench_database [iterations] [rows] [threads]
+ */
+
+#include "common.h"
+#include "storage_sqlite.h"
+#include "thread.h"
+
+#define BENCH_DB_PATH "bench_database.db"
+
+static void bench_report(const char *name, int iterations, uint64_t elapsed_us) {
+    double ns_per_op = (double)elapsed_us * 1000.0 / iterations;
+    double ops_per_sec = elapsed_us ? (double)iterations * 1000000.0 / elapsed_us : 0.0;
+    LOG_INFO("Bench", "%-24s %8d iterations  %8.1f ns/op  %10.0f ops/s",
+             name, iterations, ns_per_op, ops_per_sec);
+}
+
+/* The old per-call path: prepare, bind, step, finalize */
+static bool lookup_uncached(const char *sql, const char *text, int id) {
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL) != SQLITE_OK) return false;
+    if (text) {
+        sqlite3_bind_text(stmt, 1, text, -1, SQLITE_STATIC);
+    } else {
+        sqlite3_bind_int(stmt, 1, id);
+    }
+    bool found = sqlite3_step(stmt) == SQLITE_ROW;
+    sqlite3_finalize(stmt);
+    return found;
+}
+
+/* Concurrent lookups: each thread does its share of the iterations */
+typedef struct {
+    thread_t thread;
+    int iterations;
+    int rows;
+    int found;
+} bench_reader_t;
+
+static void bench_reader_thread(void *arg) {
+    bench_reader_t *reader = (bench_reader_t*)arg;
+    for (int i = 0; i < reader->iterations; i++) {
+        character_t character;
+        reader->found += database_get_backend()->get_character(i % reader->rows + 1, &character) == OK;
+    }
+    database_thread_release();
+}
+
+static result_t bench_populate(int rows) {
+    /* Queued without waiting, so the writer commits them in large batches */
+    db_write_t write = { .type = DB_WRITE_CREATE_ACCOUNT };
+    for (int i = 0; i < rows; i++) {
+        write.type = DB_WRITE_CREATE_ACCOUNT;
+        account_init(&write.account);
+        snprintf(write.account.username, sizeof(write.account.username), "BENCH%d", i);
+        result_t result = db_writer_submit(&write, NULL, NULL);
+        if (result != OK) return result;
+
+        /* Account ids in a fresh database run from 1 */
+        write.type = DB_WRITE_CREATE_CHARACTER;
+        character_init(&write.character);
+        write.character.account_id = i + 1;
+        snprintf(write.character.name, sizeof(write.character.name), "B%d", i);
+        write.character.race = 1;
+        write.character.char_class = 1;
+        result = db_writer_submit(&write, NULL, NULL);
+        if (result != OK) return result;
+    }
+    db_writer_flush();
+    return OK;
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    int rows = argc > 2 ? atoi(argv[2]) : 1000;
+    int threads = argc > 3 ? atoi(argv[3]) : 4;
+    if (iterations <= 0) iterations = 200000;
+    if (rows <= 0) rows = 1000;
+    if (threads <= 0) threads = 4;
+
+    remove(BENCH_DB_PATH);
+    if (database_init(BENCH_DB_PATH) != OK || bench_populate(rows) != OK) {
+        LOG_ERROR("Bench", "Failed to set up %s", BENCH_DB_PATH);
+        return 1;
+    }
+
+    char username[MAX_USERNAME + 1];
+    int found = 0;
+
+    uint64_t start = get_time_us();
+    for (int i = 0; i < iterations; i++) {
+        snprintf(username, sizeof(username), "BENCH%d", i % rows);
+        found += lookup_uncached("SELECT id, username, salt, verifier, session_key FROM accounts "
+                                 "WHERE username = ? COLLATE NOCASE", username, 0);
+    }
+    bench_report("get_account (prepare)", iterations, get_time_us() - start);
+
+    start = get_time_us();
+    for (int i = 0; i < iterations; i++) {
+        account_t account;
+        snprintf(username, sizeof(username), "BENCH%d", i % rows);
+        found += database_get_account(username, &account) == OK;
+    }
+    bench_report("get_account (cached)", iterations, get_time_us() - start);
+
+    start = get_time_us();
+    for (int i = 0; i < iterations; i++) {
+        found += lookup_uncached("SELECT id, account_id, name, race, class, gender, skin, face, "
+                                 "hair_style, hair_color, facial_hair, level, map, x, y, z, orientation "
+                                 "FROM characters WHERE id = ?", NULL, i % rows + 1);
+    }
+    bench_report("get_character (prepare)", iterations, get_time_us() - start);
+
+    start = get_time_us();
+    for (int i = 0; i < iterations; i++) {
+        character_t character;
+        found += database_get_backend()->get_character(i % rows + 1, &character) == OK;
+    }
+    bench_report("get_character (cached)", iterations, get_time_us() - start);
+
+    int threaded = 0;
+    bench_reader_t *readers = ALLOC_ARRAY(bench_reader_t, threads);
+    if (readers) {
+        threaded = iterations / threads * threads;
+        start = get_time_us();
+        for (int i = 0; i < threads; i++) {
+            readers[i].iterations = iterations / threads;
+            readers[i].rows = rows;
+            thread_create(&readers[i].thread, bench_reader_thread, &readers[i]);
+        }
+        for (int i = 0; i < threads; i++) {
+            thread_join(readers[i].thread);
+            found += readers[i].found;
+        }
+        char name[32];
+        snprintf(name, sizeof(name), "get_character (%d thr)", threads);
+        bench_report(name, threaded, get_time_us() - start);
+        free(readers);
+    }
+
+    int expected = iterations * 4 + threaded;
+    if (found != expected) {
+        LOG_ERROR("Bench", "Only %d of %d lookups found a row", found, expected);
+    }
+
+    database_shutdown();
+    remove(BENCH_DB_PATH);
+    return 0;
+}
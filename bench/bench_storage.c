@@ -0,0 +1,163 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * bench_storage.c - Read/write throughput and tail latency per storage profile
+ *
+ * Each profile gets a fresh database file, followed by the in-memory
+ * backend as a no-disk baseline. Reads are character lookups made through
+ * the backend, bypassing the character cache; writes are position saves:
+ * "sync" waits for each commit in turn, "queued" submits them all and
+ * measures submit-to-commit latency, letting the writer thread group them
+ * into batches.
+ *
+ * Usage: bench_storage [reads] [writes] [profile|memory]
+ */
+
+#include "common.h"
+#include "database.h"
+
+#define BENCH_DB_PATH "bench_storage.db"
+#define BENCH_ROWS 1000
+
+static void bench_remove_files(void) {
+    remove(BENCH_DB_PATH);
+    remove(BENCH_DB_PATH "-wal");
+    remove(BENCH_DB_PATH "-shm");
+    remove(BENCH_DB_PATH "-journal");
+}
+
+static int compare_u32(const void *a, const void *b) {
+    uint32_t x = *(const uint32_t*)a;
+    uint32_t y = *(const uint32_t*)b;
+    return (x > y) - (x < y);
+}
+
+/* Throughput plus percentiles of the per-operation latencies (sorts them) */
+static void bench_report(const char *profile, const char *name, uint32_t *latency_us,
+                         int count, uint64_t elapsed_us) {
+    qsort(latency_us, (size_t)count, sizeof(uint32_t), compare_u32);
+    double ops_per_sec = elapsed_us ? (double)count * 1000000.0 / elapsed_us : 0.0;
+    LOG_INFO("Bench", "%-8s %-6s %7d ops %10.0f ops/s  p50 %6u us  p99 %6u us  p99.9 %6u us  max %6u us",
+             profile, name, count, ops_per_sec,
+             latency_us[count / 2], latency_us[(int)(count * 0.99)],
+             latency_us[(int)(count * 0.999)], latency_us[count - 1]);
+}
+
+/* Queued writes: submit time per write, commit latency filled in by the callback */
+static uint64_t *g_submit_us;
+static uint32_t *g_commit_latency_us;
+
+static void bench_write_committed(const db_write_t *write, void *ctx) {
+    (void)write;
+    intptr_t index = (intptr_t)ctx;
+    g_commit_latency_us[index] = (uint32_t)(get_time_us() - g_submit_us[index]);
+}
+
+static result_t bench_populate(void) {
+    /* Queued without waiting, so the writer commits them in large batches */
+    db_write_t write = { .type = DB_WRITE_CREATE_ACCOUNT };
+    for (int i = 0; i < BENCH_ROWS; i++) {
+        write.type = DB_WRITE_CREATE_ACCOUNT;
+        account_init(&write.account);
+        snprintf(write.account.username, sizeof(write.account.username), "BENCH%d", i);
+        result_t result = db_writer_submit(&write, NULL, NULL);
+        if (result != OK) return result;
+
+        /* Account ids in a fresh database run from 1 */
+        write.type = DB_WRITE_CREATE_CHARACTER;
+        character_init(&write.character);
+        write.character.account_id = i + 1;
+        snprintf(write.character.name, sizeof(write.character.name), "B%d", i);
+        write.character.race = 1;
+        write.character.char_class = 1;
+        result = db_writer_submit(&write, NULL, NULL);
+        if (result != OK) return result;
+    }
+    db_writer_flush();
+    return OK;
+}
+
+/* Run the workload on the current backend and profile */
+static result_t bench_run(const char *name, int reads, int writes, uint32_t *latency_us) {
+    bench_remove_files();
+    if (database_init(BENCH_DB_PATH) != OK) return ERR_DATABASE;
+
+    result_t result = bench_populate();
+    if (result != OK) {
+        database_shutdown();
+        return result;
+    }
+
+    const storage_backend_t *backend = database_get_backend();
+    uint64_t start = get_time_us();
+    for (int i = 0; i < reads; i++) {
+        character_t character;
+        uint64_t op_start = get_time_us();
+        backend->get_character(i % BENCH_ROWS + 1, &character);
+        latency_us[i] = (uint32_t)(get_time_us() - op_start);
+    }
+    bench_report(name, "read", latency_us, reads, get_time_us() - start);
+
+    start = get_time_us();
+    for (int i = 0; i < writes; i++) {
+        uint64_t op_start = get_time_us();
+        database_update_character_position(i % BENCH_ROWS + 1, 0, (float)i, 0.0f, 0.0f, 0.0f);
+        latency_us[i] = (uint32_t)(get_time_us() - op_start);
+    }
+    bench_report(name, "sync", latency_us, writes, get_time_us() - start);
+
+    g_commit_latency_us = latency_us;
+    start = get_time_us();
+    for (int i = 0; i < writes; i++) {
+        db_write_t write = { .type = DB_WRITE_POSITION };
+        write.position.character_id = i % BENCH_ROWS + 1;
+        write.position.x = (float)i;
+        g_submit_us[i] = get_time_us();
+        db_writer_submit(&write, bench_write_committed, (void*)(intptr_t)i);
+    }
+    db_writer_flush();
+    bench_report(name, "queued", latency_us, writes, get_time_us() - start);
+
+    database_shutdown();
+    bench_remove_files();
+    return OK;
+}
+
+int main(int argc, char *argv[]) {
+    int reads = argc > 1 ? atoi(argv[1]) : 100000;
+    int writes = argc > 2 ? atoi(argv[2]) : 2000;
+    const char *only = argc > 3 ? argv[3] : NULL;
+    if (reads <= 0) reads = 100000;
+    if (writes <= 0) writes = 2000;
+
+    uint32_t *latency_us = ALLOC_ARRAY(uint32_t, reads > writes ? reads : writes);
+    g_submit_us = ALLOC_ARRAY(uint64_t, writes);
+    if (!latency_us || !g_submit_us) {
+        LOG_ERROR("Bench", "Out of memory");
+        return 1;
+    }
+
+    for (int i = 0; i < DB_PROFILE_COUNT; i++) {
+        db_profile_t profile;
+        database_profile_get((db_profile_id_t)i, &profile);
+        if (only && strcmp(only, profile.name) != 0) continue;
+
+        database_set_profile(&profile);
+        if (bench_run(profile.name, reads, writes, latency_us) != OK) {
+            LOG_ERROR("Bench", "Profile %s failed", profile.name);
+        }
+    }
+
+    if (!only || strcmp(only, storage_memory.name) == 0) {
+        database_set_backend(&storage_memory);
+        if (bench_run(storage_memory.name, reads, writes, latency_us) != OK) {
+            LOG_ERROR("Bench", "Memory storage failed");
+        }
+        database_set_backend(&storage_sqlite);
+    }
+
+    free(g_submit_us);
+    free(latency_us);
+    return 0;
+}
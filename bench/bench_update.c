@@ -0,0 +1,131 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * bench_update.c - Update block building microbenchmark
+ *
+ * Usage: bench_update [iterations]
+ */
+
+#include "common.h"
+#include "update.h"
+#include "update_template.h"
+#include "update_compress.h"
+#include "update_batch.h"
+
+/* Objects per observer per tick in the batch case */
+#define BENCH_BATCH_OBJECTS 32
+
+/* Batch sink: compress the finished packet as the session would */
+static result_t bench_batch_sink(void *ctx, const uint8_t *data, size_t size) {
+    packet_writer_t *compressed = (packet_writer_t*)ctx;
+    writer_reset(compressed);
+    if (!update_compress(data, size, compressed)) {
+        write_bytes(compressed, data, size);
+    }
+    return OK;
+}
+
+static void bench_report(const char *name, int iterations, uint64_t elapsed_us, size_t bytes) {
+    double ns_per_op = (double)elapsed_us * 1000.0 / iterations;
+    LOG_INFO("Bench", "%-14s %8d iterations  %8.1f ns/op  %5zu bytes/block",
+             name, iterations, ns_per_op, bytes / (size_t)iterations);
+}
+
+int main(int argc, char *argv[]) {
+    int iterations = argc > 1 ? atoi(argv[1]) : 200000;
+    if (iterations <= 0) iterations = 200000;
+
+    character_t character;
+    character_init(&character);
+    character.id = 42;
+    safe_strncpy(character.name, "Bench", sizeof(character.name));
+    character.race = 1;
+    character.char_class = 1;
+    character.level = 1;
+
+    player_t *player = ALLOC(player_t);
+    update_builder_t *builder = ALLOC(update_builder_t);
+    packet_writer_t packet;
+    if (!player || !builder || writer_init(&packet) != OK) {
+        LOG_ERROR("Bench", "Out of memory");
+        return 1;
+    }
+    player_init(player, &character);
+
+    /* Create block, as sent for every player coming into view */
+    size_t bytes = 0;
+    uint64_t start = get_time_us();
+    for (int i = 0; i < iterations; i++) {
+        update_builder_init(builder);
+        writer_reset(&packet);
+        update_build_create_packet(builder, player, false, &packet);
+        bytes += writer_size(&packet);
+    }
+    bench_report("create", iterations, get_time_us() - start, bytes);
+
+    /* Same block from the cached template */
+    update_template_init();
+    bytes = 0;
+    start = get_time_us();
+    for (int i = 0; i < iterations; i++) {
+        writer_reset(&packet);
+        update_template_build_create(player, false, &packet);
+        bytes += writer_size(&packet);
+    }
+    bench_report("create (tmpl)", iterations, get_time_us() - start, bytes);
+    update_template_shutdown();
+
+    /* Compressing a create block (reused per-thread deflate stream) */
+    packet_writer_t compressed;
+    writer_init(&compressed);
+    bytes = 0;
+    start = get_time_us();
+    for (int i = 0; i < iterations; i++) {
+        writer_reset(&compressed);
+        if (!update_compress(writer_data(&packet), writer_size(&packet), &compressed)) break;
+        bytes += writer_size(&compressed);
+    }
+    bench_report("compress", iterations, get_time_us() - start, bytes);
+
+    /* Creates batched per observer: one packet and one compression pass
+     * for BENCH_BATCH_OBJECTS blocks (reported per block) */
+    update_template_init();
+    update_batch_t batch;
+    update_batch_init(&batch, bench_batch_sink, &compressed);
+    int batches = iterations / BENCH_BATCH_OBJECTS > 0 ? iterations / BENCH_BATCH_OBJECTS : 1;
+    bytes = 0;
+    start = get_time_us();
+    for (int i = 0; i < batches; i++) {
+        for (int j = 0; j < BENCH_BATCH_OBJECTS; j++) {
+            player->guid = (uint64_t)(j + 1);
+            field_store_set_guid(&player->fields, OBJECT_FIELD_GUID, player->guid);
+            update_batch_add_create(&batch, player, false);
+        }
+        update_batch_flush(&batch);
+        bytes += writer_size(&compressed);
+    }
+    bench_report("create (batch)", batches * BENCH_BATCH_OBJECTS, get_time_us() - start, bytes);
+    update_batch_free(&batch);
+    update_template_shutdown();
+
+    writer_free(&compressed);
+    update_compress_thread_cleanup();
+
+    /* Values block with a single changed field */
+    bytes = 0;
+    start = get_time_us();
+    for (int i = 0; i < iterations; i++) {
+        player_set_stand_state(player, (uint8_t)(i & 1));
+        writer_reset(&packet);
+        update_build_values_packet(player, &packet);
+        field_store_clear_dirty(&player->fields);
+        bytes += writer_size(&packet);
+    }
+    bench_report("values", iterations, get_time_us() - start, bytes);
+
+    writer_free(&packet);
+    free(builder);
+    free(player);
+    return 0;
+}
@@ -0,0 +1,48 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * arena.h - Bump-pointer arena for short-lived allocations
+ */
+
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "common.h"
+
+/* Default size of the block an arena keeps between resets */
+#define ARENA_BLOCK_SIZE 4096
+
+/* Largest block an arena keeps between resets */
+#define ARENA_KEEP_MAX (64 * 1024)
+
+/* Alignment of every arena allocation */
+#define ARENA_ALIGN 16
+
+/* Arena memory block */
+typedef struct arena_block {
+    struct arena_block *next;
+    size_t size;
+    size_t used;
+    uint8_t data[];
+} arena_block_t;
+
+/* Arena (not thread-safe, owned by one session or thread at a time) */
+typedef struct {
+    arena_block_t *blocks;   /* Current block first */
+    size_t block_size;
+} arena_t;
+
+/* Initialize an arena; the first block is allocated on first use */
+void arena_init(arena_t *arena, size_t block_size);
+
+/* Free every block */
+void arena_free(arena_t *arena);
+
+/* Allocate size bytes (aligned, uninitialized), NULL if out of memory */
+void *arena_alloc(arena_t *arena, size_t size);
+
+/* Release everything allocated so far, keeping one block for reuse */
+void arena_reset(arena_t *arena);
+
+#endif /* ARENA_H */
@@ -71,6 +71,28 @@ typedef enum {
 #define ALLOC_ARRAY(type, count) ((type*)calloc((count), sizeof(type)))
 #define FREE(ptr) do { if (ptr) { free(ptr); (ptr) = NULL; } } while(0)
 
+/* Bit helpers for 64-bit masks */
+#ifdef _MSC_VER
+    #include <intrin.h>
+    static inline int bit_count64(uint64_t value) {
+        return (int)__popcnt64(value);
+    }
+    /* Index of the lowest set bit (value must be non-zero) */
+    static inline int bit_lowest64(uint64_t value) {
+        unsigned long index;
+        _BitScanForward64(&index, value);
+        return (int)index;
+    }
+#else
+    static inline int bit_count64(uint64_t value) {
+        return __builtin_popcountll(value);
+    }
+    /* Index of the lowest set bit (value must be non-zero) */
+    static inline int bit_lowest64(uint64_t value) {
+        return __builtin_ctzll(value);
+    }
+#endif
+
 /* String helpers */
 #define MAX_USERNAME 32
 #define MAX_CHARACTER_NAME 12
@@ -86,6 +108,9 @@ void network_cleanup(void);
 /* Get current tick count in milliseconds */
 uint32_t get_tick_count(void);
 
+/* Get monotonic time in microseconds (for profiling) */
+uint64_t get_time_us(void);
+
 /* Convert string to uppercase in-place */
 void to_upper(char *str);
 
@@ -58,12 +58,19 @@ result_t client_send_all(client_t *client, const uint8_t *buf, size_t len);
 /* Close client connection */
 void client_close(client_t *client);
 
+/* Shut down both directions without closing (safe from another thread) */
+void client_shutdown(client_t *client);
+
 /* Check if client is connected */
 bool client_is_connected(const client_t *client);
 
 /* Free client resources (called after handler returns or when closing) */
 void client_free(client_t *client);
 
+/* Set up / release the client allocator (called by network_init / network_cleanup) */
+void client_cache_init(void);
+void client_cache_shutdown(void);
+
 /* Create client from accepted socket (internal use) */
 client_t *client_create(socket_t sock, struct sockaddr_in *addr);
 
@@ -63,6 +63,7 @@ typedef enum {
 
     /* Updates */
     SMSG_UPDATE_OBJECT = 0x00A9,
+    SMSG_COMPRESSED_UPDATE_OBJECT = 0x01F6,
     SMSG_DESTROY_OBJECT = 0x00AA,
 
     /* Movement */
@@ -105,6 +106,7 @@ typedef enum {
 
     /* Standstate */
     CMSG_STANDSTATECHANGE = 0x0101,
+    SMSG_STANDSTATE_UPDATE = 0x029D,
 
     /* Set selection */
     CMSG_SET_SELECTION = 0x013D,
@@ -192,6 +194,19 @@ typedef enum {
     UPDATETYPE_NEAR_OBJECTS = 5
 } update_type_t;
 
+/* Unit stand states (UNIT_FIELD_BYTES_1, byte 0) */
+typedef enum {
+    UNIT_STAND_STATE_STAND = 0,
+    UNIT_STAND_STATE_SIT = 1,
+    UNIT_STAND_STATE_SIT_CHAIR = 2,
+    UNIT_STAND_STATE_SLEEP = 3,
+    UNIT_STAND_STATE_SIT_LOW_CHAIR = 4,
+    UNIT_STAND_STATE_SIT_MEDIUM_CHAIR = 5,
+    UNIT_STAND_STATE_SIT_HIGH_CHAIR = 6,
+    UNIT_STAND_STATE_DEAD = 7,
+    UNIT_STAND_STATE_KNEEL = 8
+} unit_stand_state_t;
+
 /* Update flags (TBC 2.4.3 format) */
 typedef enum {
     UPDATEFLAG_NONE = 0x0000,
@@ -10,8 +10,44 @@
 
 #include "common.h"
 
-/* Maximum packet size */
-#define PACKET_MAX_SIZE 65536
+/* Maximum packet size (server packets over 32 KB use the large header) */
+#define PACKET_MAX_SIZE (1024 * 1024)
+
+/* Unaligned little-endian loads (memcpy compiles to a single move) */
+static inline uint16_t load_le16(const uint8_t *in) {
+    uint16_t value;
+    memcpy(&value, in, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap16(value);
+#endif
+    return value;
+}
+
+static inline uint32_t load_le32(const uint8_t *in) {
+    uint32_t value;
+    memcpy(&value, in, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap32(value);
+#endif
+    return value;
+}
+
+static inline uint64_t load_le64(const uint8_t *in) {
+    uint64_t value;
+    memcpy(&value, in, sizeof(value));
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    value = __builtin_bswap64(value);
+#endif
+    return value;
+}
+
+/* Store a little-endian uint32 into a reserved buffer */
+static inline void store_le32(uint8_t *out, uint32_t value) {
+    out[0] = (uint8_t)value;
+    out[1] = (uint8_t)(value >> 8);
+    out[2] = (uint8_t)(value >> 16);
+    out[3] = (uint8_t)(value >> 24);
+}
 
 /* Packet reader structure */
 typedef struct {
@@ -20,13 +56,40 @@ typedef struct {
     size_t pos;
 } packet_reader_t;
 
-/* Packet writer structure */
+/* Bytes a writer holds before it spills to the heap */
+#define PACKET_INLINE_SIZE 256
+
+/* Packet writer structure. Data lives in the inline buffer until it
+ * outgrows it, so a writer must not be copied by value. */
 typedef struct {
     uint8_t *data;
     size_t size;
     size_t capacity;
+    uint8_t inline_data[PACKET_INLINE_SIZE];
 } packet_writer_t;
 
+/* Heap writer buffers are pooled per thread in power-of-two size classes
+ * from 512 bytes to 64 KB; bigger buffers go straight to malloc */
+#define PACKET_POOL_MIN_SHIFT 9
+#define PACKET_POOL_MAX_SHIFT 16
+#define PACKET_POOL_CLASSES   (PACKET_POOL_MAX_SHIFT - PACKET_POOL_MIN_SHIFT + 1)
+
+/* Buffer pool counters (all threads) */
+typedef struct {
+    uint64_t hits;      /* Buffers taken from a pool */
+    uint64_t misses;    /* Buffers that had to be malloc'd */
+    uint64_t releases;  /* Buffers returned to a pool */
+    uint64_t discards;  /* Buffers freed because the pool was full or they were too big */
+    uint64_t trimmed;   /* Buffers freed by packet_pool_trim */
+} packet_pool_stats_t;
+
+/* Writer allocation counters (all threads) */
+typedef struct {
+    uint64_t writers;        /* writer_init calls */
+    uint64_t heap_allocs;    /* Writers that outgrew the inline buffer */
+    uint64_t heap_reallocs;  /* Further growth of heap buffers */
+} packet_alloc_stats_t;
+
 /* Reader functions */
 void reader_init(packet_reader_t *reader, const uint8_t *data, size_t size);
 size_t reader_remaining(const packet_reader_t *reader);
@@ -40,6 +103,41 @@ float read_float(packet_reader_t *reader);
 void read_bytes(packet_reader_t *reader, uint8_t *dst, size_t count);
 void read_bytes_reverse(packet_reader_t *reader, uint8_t *dst, size_t count);
 
+/* Fast path for fixed-layout messages: one reader_require() up front,
+ * then the unchecked reads below, which must stay within those bytes */
+static inline bool reader_require(const packet_reader_t *reader, size_t count) {
+    return reader->size - reader->pos >= count;
+}
+
+static inline uint8_t read_uint8_unchecked(packet_reader_t *reader) {
+    return reader->data[reader->pos++];
+}
+
+static inline uint16_t read_uint16_unchecked(packet_reader_t *reader) {
+    uint16_t value = load_le16(reader->data + reader->pos);
+    reader->pos += 2;
+    return value;
+}
+
+static inline uint32_t read_uint32_unchecked(packet_reader_t *reader) {
+    uint32_t value = load_le32(reader->data + reader->pos);
+    reader->pos += 4;
+    return value;
+}
+
+static inline uint64_t read_uint64_unchecked(packet_reader_t *reader) {
+    uint64_t value = load_le64(reader->data + reader->pos);
+    reader->pos += 8;
+    return value;
+}
+
+static inline float read_float_unchecked(packet_reader_t *reader) {
+    float value;
+    uint32_t bits = read_uint32_unchecked(reader);
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
 /* Read null-terminated string, returns length written (including null) */
 size_t read_cstring(packet_reader_t *reader, char *dst, size_t dst_size);
 
@@ -53,6 +151,18 @@ void writer_reset(packet_writer_t *writer);
 const uint8_t *writer_data(const packet_writer_t *writer);
 size_t writer_size(const packet_writer_t *writer);
 
+/* Get writer allocation counters */
+void packet_get_alloc_stats(packet_alloc_stats_t *stats);
+
+/* Free every buffer cached by the calling thread (call before it exits) */
+void packet_pool_trim(void);
+
+/* Get buffer pool counters */
+void packet_pool_get_stats(packet_pool_stats_t *stats);
+
+/* Append count bytes and return a pointer to fill them in (NULL if full) */
+uint8_t *writer_reserve(packet_writer_t *writer, size_t count);
+
 result_t write_uint8(packet_writer_t *writer, uint8_t value);
 result_t write_uint16(packet_writer_t *writer, uint16_t value);
 result_t write_uint32(packet_writer_t *writer, uint32_t value);
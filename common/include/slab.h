@@ -0,0 +1,69 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * slab.h - Fixed-size object caches for per-connection structures
+ */
+
+#ifndef SLAB_H
+#define SLAB_H
+
+#include "common.h"
+#include "thread.h"
+
+/* Objects are aligned and padded to whole cache lines */
+#define CACHE_LINE_SIZE 64
+
+/* Slab cache occupancy */
+typedef struct {
+    size_t object_size;  /* After padding to a cache line multiple */
+    int slabs;
+    int capacity;        /* Objects across all slabs */
+    int in_use;
+    int peak;            /* Most objects in use at once */
+    uint64_t allocs;
+    uint64_t frees;
+} slab_stats_t;
+
+/* Free object, the link lives in its first bytes */
+typedef struct slab_object {
+    struct slab_object *next;
+} slab_object_t;
+
+/* Slab memory, linked through a header in its first cache line */
+typedef struct slab {
+    struct slab *next;
+} slab_t;
+
+/* Cache of equally sized objects */
+typedef struct {
+    const char *name;
+    size_t object_size;
+    int objects_per_slab;
+    mutex_t lock;
+    slab_t *slabs;
+    slab_object_t *free_list;
+    slab_stats_t stats;
+    bool initialized;
+} slab_cache_t;
+
+/* Set up a cache for objects of object_size bytes, objects_per_slab at a time */
+void slab_cache_init(slab_cache_t *cache, const char *name, size_t object_size, int objects_per_slab);
+
+/* Free all slabs. Does nothing while objects are still in use, so threads
+ * that outlive their server can still release theirs. */
+void slab_cache_destroy(slab_cache_t *cache);
+
+/* Get a zeroed object, NULL if out of memory */
+void *slab_alloc(slab_cache_t *cache);
+
+/* Return an object to its cache */
+void slab_free(slab_cache_t *cache, void *object);
+
+/* Get occupancy counters */
+void slab_get_stats(slab_cache_t *cache, slab_stats_t *stats);
+
+/* Log occupancy counters */
+void slab_log_stats(slab_cache_t *cache, const char *module);
+
+#endif /* SLAB_H */
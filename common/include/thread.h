@@ -0,0 +1,96 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * thread.h - Portable mutex and thread wrappers
+ */
+
+#ifndef THREAD_H
+#define THREAD_H
+
+#include "common.h"
+
+#ifdef _WIN32
+    #include <windows.h>
+    typedef CRITICAL_SECTION mutex_t;
+    typedef CONDITION_VARIABLE cond_t;
+    typedef HANDLE thread_t;
+#else
+    #include <pthread.h>
+    typedef pthread_mutex_t mutex_t;
+    typedef pthread_cond_t cond_t;
+    typedef pthread_t thread_t;
+#endif
+
+/* Thread-local storage qualifier */
+#ifdef _MSC_VER
+    #define THREAD_LOCAL __declspec(thread)
+#else
+    #define THREAD_LOCAL _Thread_local
+#endif
+
+/* Thread entry point */
+typedef void (*thread_func_t)(void *arg);
+
+/* Mutex functions */
+void mutex_init(mutex_t *mutex);
+void mutex_destroy(mutex_t *mutex);
+void mutex_lock(mutex_t *mutex);
+void mutex_unlock(mutex_t *mutex);
+
+/* Condition variable functions (waits are called with the mutex held) */
+void cond_init(cond_t *cond);
+void cond_destroy(cond_t *cond);
+void cond_wait(cond_t *cond, mutex_t *mutex);
+void cond_timed_wait(cond_t *cond, mutex_t *mutex, uint32_t ms);
+void cond_signal(cond_t *cond);
+void cond_broadcast(cond_t *cond);
+
+/* Start a new thread running func(arg) */
+result_t thread_create(thread_t *thread, thread_func_t func, void *arg);
+
+/* Wait for a thread to finish */
+void thread_join(thread_t thread);
+
+/* Let a thread release its resources on exit */
+void thread_detach(thread_t thread);
+
+/* Sleep the calling thread */
+void thread_sleep_ms(uint32_t ms);
+
+/* Atomic counters (return the new value) and pointer exchange/load/store */
+#ifdef _WIN32
+static inline int32_t atomic_add_int32(volatile int32_t *value, int32_t delta) {
+    return (int32_t)InterlockedExchangeAdd((volatile LONG*)value, delta) + delta;
+}
+static inline uint64_t atomic_add_uint64(volatile uint64_t *value, uint64_t delta) {
+    return (uint64_t)InterlockedExchangeAdd64((volatile LONG64*)value, (LONG64)delta) + delta;
+}
+static inline void *atomic_exchange_ptr(void *volatile *target, void *value) {
+    return InterlockedExchangePointer(target, value);
+}
+static inline void *atomic_load_ptr(void *volatile *source) {
+    return InterlockedCompareExchangePointer(source, NULL, NULL);
+}
+static inline void atomic_store_ptr(void *volatile *target, void *value) {
+    InterlockedExchangePointer(target, value);
+}
+#else
+static inline int32_t atomic_add_int32(volatile int32_t *value, int32_t delta) {
+    return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+}
+static inline uint64_t atomic_add_uint64(volatile uint64_t *value, uint64_t delta) {
+    return __atomic_add_fetch(value, delta, __ATOMIC_RELAXED);
+}
+static inline void *atomic_exchange_ptr(void *volatile *target, void *value) {
+    return __atomic_exchange_n(target, value, __ATOMIC_ACQ_REL);
+}
+static inline void *atomic_load_ptr(void *volatile *source) {
+    return __atomic_load_n(source, __ATOMIC_ACQUIRE);
+}
+static inline void atomic_store_ptr(void *volatile *target, void *value) {
+    __atomic_store_n(target, value, __ATOMIC_RELEASE);
+}
+#endif
+
+#endif /* THREAD_H */
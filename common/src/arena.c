@@ -0,0 +1,85 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * arena.c - Bump-pointer arena for short-lived allocations
+ *
+ * Allocations are carved off the current block by bumping an offset and
+ * are never freed individually. A reset drops every block but one and
+ * rewinds it, so a session that handles one packet after another keeps
+ * reusing the same memory. If a reset finds overflow blocks, the kept
+ * block is resized to cover all of them (up to ARENA_KEEP_MAX), so the next
+ * packet of the same kind fits in one block.
+ */
+
+#include "arena.h"
+
+static arena_block_t *arena_block_create(size_t size) {
+    arena_block_t *block = (arena_block_t*)malloc(sizeof(arena_block_t) + size);
+    if (!block) return NULL;
+    block->next = NULL;
+    block->size = size;
+    block->used = 0;
+    return block;
+}
+
+void arena_init(arena_t *arena, size_t block_size) {
+    arena->blocks = NULL;
+    arena->block_size = block_size > 0 ? block_size : ARENA_BLOCK_SIZE;
+}
+
+void arena_free(arena_t *arena) {
+    arena_block_t *block = arena->blocks;
+    while (block) {
+        arena_block_t *next = block->next;
+        free(block);
+        block = next;
+    }
+    arena->blocks = NULL;
+}
+
+/* Offset of the next aligned allocation in a block */
+static size_t arena_block_offset(const arena_block_t *block) {
+    uintptr_t address = (uintptr_t)(block->data + block->used);
+    uintptr_t aligned = (address + ARENA_ALIGN - 1) & ~(uintptr_t)(ARENA_ALIGN - 1);
+    return block->used + (size_t)(aligned - address);
+}
+
+void *arena_alloc(arena_t *arena, size_t size) {
+    arena_block_t *block = arena->blocks;
+    size_t offset = block ? arena_block_offset(block) : 0;
+
+    if (!block || offset + size > block->size) {
+        /* New block in front; big requests get a block of their own */
+        size_t block_size = size + ARENA_ALIGN > arena->block_size ? size + ARENA_ALIGN : arena->block_size;
+        arena_block_t *fresh = arena_block_create(block_size);
+        if (!fresh) return NULL;
+        fresh->next = block;
+        arena->blocks = block = fresh;
+        offset = arena_block_offset(block);
+    }
+
+    block->used = offset + size;
+    return block->data + offset;
+}
+
+void arena_reset(arena_t *arena) {
+    arena_block_t *block = arena->blocks;
+    if (!block) return;
+
+    if (!block->next && block->size <= ARENA_KEEP_MAX) {
+        block->used = 0;
+        return;
+    }
+
+    /* Replace the blocks with a single one that would have held them all */
+    size_t total = 0;
+    while (block) {
+        arena_block_t *next = block->next;
+        total += block->size;
+        free(block);
+        block = next;
+    }
+    if (total > ARENA_KEEP_MAX) total = ARENA_KEEP_MAX;
+    arena->blocks = arena_block_create(total);
+}
@@ -6,6 +6,7 @@
  */
 
 #include "common.h"
+#include "network.h"
 #include <ctype.h>
 
 #ifdef _WIN32
@@ -29,10 +30,12 @@ int network_init(void) {
 #else
     g_network_initialized = true;
 #endif
+    client_cache_init();
     return OK;
 }
 
 void network_cleanup(void) {
+    client_cache_shutdown();
 #ifdef _WIN32
     if (g_network_initialized) {
         WSACleanup();
@@ -51,6 +54,22 @@ uint32_t get_tick_count(void) {
 #endif
 }
 
+uint64_t get_time_us(void) {
+#ifdef _WIN32
+    static LARGE_INTEGER frequency;
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    return (uint64_t)(counter.QuadPart * 1000000 / frequency.QuadPart);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000 + (uint64_t)ts.tv_nsec / 1000;
+#endif
+}
+
 void to_upper(char *str) {
     if (!str) return;
     while (*str) {
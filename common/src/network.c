@@ -6,6 +6,10 @@
  */
 
 #include "network.h"
+#include "slab.h"
+
+/* Clients per slab */
+#define CLIENT_SLAB_OBJECTS 64
 
 /* Server structure */
 struct server {
@@ -22,6 +26,17 @@ struct client {
     bool connected;
 };
 
+static slab_cache_t g_client_cache;
+
+void client_cache_init(void) {
+    slab_cache_init(&g_client_cache, "client_t", sizeof(struct client), CLIENT_SLAB_OBJECTS);
+}
+
+void client_cache_shutdown(void) {
+    slab_log_stats(&g_client_cache, "Network");
+    slab_cache_destroy(&g_client_cache);
+}
+
 /* Create TCP server */
 server_t *server_create(int port, const char *name) {
     server_t *server = ALLOC(server_t);
@@ -145,7 +160,7 @@ const char *server_get_name(const server_t *server) {
 
 /* Create client from accepted socket */
 client_t *client_create(socket_t sock, struct sockaddr_in *addr) {
-    client_t *client = ALLOC(client_t);
+    client_t *client = (client_t*)slab_alloc(&g_client_cache);
     if (!client) {
         socket_close(sock);
         return NULL;
@@ -200,7 +215,12 @@ result_t client_recv_exact(client_t *client, uint8_t *buf, size_t len) {
 ssize_t client_send(client_t *client, const uint8_t *buf, size_t len) {
     if (!client->connected) return -1;
 
+#ifdef MSG_NOSIGNAL
+    /* A peer shut down mid-send must not raise SIGPIPE */
+    ssize_t result = send(client->sock, (const char*)buf, (int)len, MSG_NOSIGNAL);
+#else
     ssize_t result = send(client->sock, (const char*)buf, (int)len, 0);
+#endif
     if (result < 0) {
         client->connected = false;
     }
@@ -229,6 +249,17 @@ void client_close(client_t *client) {
     }
 }
 
+/* Wake any thread blocked on the socket; the owner still closes it */
+void client_shutdown(client_t *client) {
+    if (client->connected) {
+#ifdef _WIN32
+        shutdown(client->sock, SD_BOTH);
+#else
+        shutdown(client->sock, SHUT_RDWR);
+#endif
+    }
+}
+
 /* Check if client is connected */
 bool client_is_connected(const client_t *client) {
     return client->connected;
@@ -238,5 +269,5 @@ bool client_is_connected(const client_t *client) {
 void client_free(client_t *client) {
     if (!client) return;
     client_close(client);
-    free(client);
+    slab_free(&g_client_cache, client);
 }
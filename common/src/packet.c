@@ -6,9 +6,98 @@
  */
 
 #include "packet.h"
+#include "thread.h"
 
-/* Initial writer capacity */
-#define INITIAL_CAPACITY 256
+/* Cached buffers per size class are capped at this many bytes... */
+#define POOL_CLASS_BYTES (64 * 1024)
+
+/* ...and at this many buffers */
+#define POOL_CLASS_MAX 8
+
+/* Free buffer, the link lives in its first bytes */
+typedef struct pool_buffer {
+    struct pool_buffer *next;
+} pool_buffer_t;
+
+/* Per-thread buffer cache */
+typedef struct {
+    pool_buffer_t *free[PACKET_POOL_CLASSES];
+    int count[PACKET_POOL_CLASSES];
+} buffer_pool_t;
+
+static THREAD_LOCAL buffer_pool_t t_pool;
+
+static packet_alloc_stats_t g_alloc_stats;
+static packet_pool_stats_t g_pool_stats;
+
+/* Size class holding at least size bytes, -1 if too big to pool */
+static int pool_class(size_t size) {
+    int shift = PACKET_POOL_MIN_SHIFT;
+    while (((size_t)1 << shift) < size) {
+        if (++shift > PACKET_POOL_MAX_SHIFT) return -1;
+    }
+    return shift - PACKET_POOL_MIN_SHIFT;
+}
+
+static int pool_class_limit(int cls) {
+    int limit = POOL_CLASS_BYTES >> (cls + PACKET_POOL_MIN_SHIFT);
+    if (limit < 1) limit = 1;
+    return limit < POOL_CLASS_MAX ? limit : POOL_CLASS_MAX;
+}
+
+/* Get a buffer of at least *capacity bytes; *capacity is rounded up to its class */
+static uint8_t *pool_acquire(size_t *capacity) {
+    int cls = pool_class(*capacity);
+    if (cls < 0) {
+        atomic_add_uint64(&g_pool_stats.misses, 1);
+        return (uint8_t*)malloc(*capacity);
+    }
+
+    *capacity = (size_t)1 << (cls + PACKET_POOL_MIN_SHIFT);
+
+    pool_buffer_t *buffer = t_pool.free[cls];
+    if (buffer) {
+        t_pool.free[cls] = buffer->next;
+        t_pool.count[cls]--;
+        atomic_add_uint64(&g_pool_stats.hits, 1);
+        return (uint8_t*)buffer;
+    }
+
+    atomic_add_uint64(&g_pool_stats.misses, 1);
+    return (uint8_t*)malloc(*capacity);
+}
+
+/* Return a buffer obtained from pool_acquire */
+static void pool_release(uint8_t *data, size_t capacity) {
+    int cls = pool_class(capacity);
+    if (cls < 0 || t_pool.count[cls] >= pool_class_limit(cls)) {
+        atomic_add_uint64(&g_pool_stats.discards, 1);
+        free(data);
+        return;
+    }
+
+    pool_buffer_t *buffer = (pool_buffer_t*)data;
+    buffer->next = t_pool.free[cls];
+    t_pool.free[cls] = buffer;
+    t_pool.count[cls]++;
+    atomic_add_uint64(&g_pool_stats.releases, 1);
+}
+
+void packet_pool_trim(void) {
+    for (int cls = 0; cls < PACKET_POOL_CLASSES; cls++) {
+        while (t_pool.free[cls]) {
+            pool_buffer_t *buffer = t_pool.free[cls];
+            t_pool.free[cls] = buffer->next;
+            free(buffer);
+            atomic_add_uint64(&g_pool_stats.trimmed, 1);
+        }
+        t_pool.count[cls] = 0;
+    }
+}
+
+void packet_pool_get_stats(packet_pool_stats_t *stats) {
+    *stats = g_pool_stats;
+}
 
 /* Reader functions */
 
@@ -36,31 +125,18 @@ uint8_t read_uint8(packet_reader_t *reader) {
 }
 
 uint16_t read_uint16(packet_reader_t *reader) {
-    if (reader->pos + 2 > reader->size) return 0;
-    uint16_t value = reader->data[reader->pos] |
-                     ((uint16_t)reader->data[reader->pos + 1] << 8);
-    reader->pos += 2;
-    return value;
+    if (!reader_require(reader, 2)) return 0;
+    return read_uint16_unchecked(reader);
 }
 
 uint32_t read_uint32(packet_reader_t *reader) {
-    if (reader->pos + 4 > reader->size) return 0;
-    uint32_t value = reader->data[reader->pos] |
-                     ((uint32_t)reader->data[reader->pos + 1] << 8) |
-                     ((uint32_t)reader->data[reader->pos + 2] << 16) |
-                     ((uint32_t)reader->data[reader->pos + 3] << 24);
-    reader->pos += 4;
-    return value;
+    if (!reader_require(reader, 4)) return 0;
+    return read_uint32_unchecked(reader);
 }
 
 uint64_t read_uint64(packet_reader_t *reader) {
-    if (reader->pos + 8 > reader->size) return 0;
-    uint64_t value = 0;
-    for (int i = 0; i < 8; i++) {
-        value |= ((uint64_t)reader->data[reader->pos + i]) << (i * 8);
-    }
-    reader->pos += 8;
-    return value;
+    if (!reader_require(reader, 8)) return 0;
+    return read_uint64_unchecked(reader);
 }
 
 float read_float(packet_reader_t *reader) {
@@ -132,8 +208,17 @@ static result_t writer_ensure_capacity(packet_writer_t *writer, size_t additiona
     if (new_capacity < needed) new_capacity = needed;
     if (new_capacity > PACKET_MAX_SIZE) new_capacity = PACKET_MAX_SIZE;
 
-    uint8_t *new_data = (uint8_t*)realloc(writer->data, new_capacity);
+    uint8_t *new_data = pool_acquire(&new_capacity);
     if (!new_data) return ERR_MEMORY;
+    memcpy(new_data, writer->data, writer->size);
+
+    if (writer->data == writer->inline_data) {
+        /* First spill out of the inline buffer */
+        atomic_add_uint64(&g_alloc_stats.heap_allocs, 1);
+    } else {
+        pool_release(writer->data, writer->capacity);
+        atomic_add_uint64(&g_alloc_stats.heap_reallocs, 1);
+    }
 
     writer->data = new_data;
     writer->capacity = new_capacity;
@@ -141,23 +226,30 @@ static result_t writer_ensure_capacity(packet_writer_t *writer, size_t additiona
 }
 
 result_t writer_init(packet_writer_t *writer) {
-    writer->data = (uint8_t*)malloc(INITIAL_CAPACITY);
-    if (!writer->data) return ERR_MEMORY;
+    writer->data = writer->inline_data;
     writer->size = 0;
-    writer->capacity = INITIAL_CAPACITY;
+    writer->capacity = PACKET_INLINE_SIZE;
+    atomic_add_uint64(&g_alloc_stats.writers, 1);
     return OK;
 }
 
 void writer_free(packet_writer_t *writer) {
-    FREE(writer->data);
+    if (writer->data != writer->inline_data) {
+        pool_release(writer->data, writer->capacity);
+    }
+    writer->data = writer->inline_data;
     writer->size = 0;
-    writer->capacity = 0;
+    writer->capacity = PACKET_INLINE_SIZE;
 }
 
 void writer_reset(packet_writer_t *writer) {
     writer->size = 0;
 }
 
+void packet_get_alloc_stats(packet_alloc_stats_t *stats) {
+    *stats = g_alloc_stats;
+}
+
 const uint8_t *writer_data(const packet_writer_t *writer) {
     return writer->data;
 }
@@ -166,6 +258,13 @@ size_t writer_size(const packet_writer_t *writer) {
     return writer->size;
 }
 
+uint8_t *writer_reserve(packet_writer_t *writer, size_t count) {
+    if (writer_ensure_capacity(writer, count) != OK) return NULL;
+    uint8_t *out = writer->data + writer->size;
+    writer->size += count;
+    return out;
+}
+
 result_t write_uint8(packet_writer_t *writer, uint8_t value) {
     result_t r = writer_ensure_capacity(writer, 1);
     if (r != OK) return r;
@@ -0,0 +1,134 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * slab.c - Fixed-size object caches for per-connection structures
+ *
+ * Each slab is one cache-line aligned block holding a header line followed
+ * by objects_per_slab objects, each padded to whole cache lines so two
+ * sessions never share one. A new slab is zeroed right away, which faults
+ * its pages in while the cache lock is held once rather than on the first
+ * touch of every object. Freed objects go onto a free list and are never
+ * handed back to the system until the cache is destroyed, so connection
+ * churn does not reach the global allocator at all.
+ */
+
+#include "slab.h"
+
+#ifdef _WIN32
+    #include <malloc.h>
+    #define slab_memory_alloc(size) _aligned_malloc((size), CACHE_LINE_SIZE)
+    #define slab_memory_free(ptr) _aligned_free(ptr)
+#else
+    #define slab_memory_alloc(size) aligned_alloc(CACHE_LINE_SIZE, (size))
+    #define slab_memory_free(ptr) free(ptr)
+#endif
+
+void slab_cache_init(slab_cache_t *cache, const char *name, size_t object_size, int objects_per_slab) {
+    if (cache->initialized) return;
+
+    memset(cache, 0, sizeof(slab_cache_t));
+    cache->name = name;
+    cache->object_size = (object_size + CACHE_LINE_SIZE - 1) & ~(size_t)(CACHE_LINE_SIZE - 1);
+    cache->objects_per_slab = objects_per_slab > 0 ? objects_per_slab : 1;
+    cache->stats.object_size = cache->object_size;
+    mutex_init(&cache->lock);
+    cache->initialized = true;
+}
+
+void slab_cache_destroy(slab_cache_t *cache) {
+    if (!cache->initialized) return;
+
+    mutex_lock(&cache->lock);
+    bool busy = cache->stats.in_use > 0;
+    mutex_unlock(&cache->lock);
+    if (busy) {
+        LOG_INFO("Slab", "%s: %d objects still in use, keeping slabs", cache->name, cache->stats.in_use);
+        return;
+    }
+
+    slab_t *slab = cache->slabs;
+    while (slab) {
+        slab_t *next = slab->next;
+        slab_memory_free(slab);
+        slab = next;
+    }
+    mutex_destroy(&cache->lock);
+    cache->initialized = false;
+}
+
+/* Add a slab and thread its objects onto the free list, caller holds the lock */
+static bool slab_grow(slab_cache_t *cache) {
+    size_t size = CACHE_LINE_SIZE + cache->object_size * (size_t)cache->objects_per_slab;
+    uint8_t *memory = (uint8_t*)slab_memory_alloc(size);
+    if (!memory) return false;
+
+    /* Pre-fault every page now */
+    memset(memory, 0, size);
+
+    slab_t *slab = (slab_t*)memory;
+    slab->next = cache->slabs;
+    cache->slabs = slab;
+
+    /* Push in reverse so objects are handed out in address order */
+    for (int i = cache->objects_per_slab - 1; i >= 0; i--) {
+        slab_object_t *object = (slab_object_t*)(memory + CACHE_LINE_SIZE + cache->object_size * (size_t)i);
+        object->next = cache->free_list;
+        cache->free_list = object;
+    }
+
+    cache->stats.slabs++;
+    cache->stats.capacity += cache->objects_per_slab;
+    return true;
+}
+
+void *slab_alloc(slab_cache_t *cache) {
+    mutex_lock(&cache->lock);
+
+    if (!cache->free_list && !slab_grow(cache)) {
+        mutex_unlock(&cache->lock);
+        return NULL;
+    }
+
+    slab_object_t *object = cache->free_list;
+    cache->free_list = object->next;
+
+    cache->stats.allocs++;
+    cache->stats.in_use++;
+    if (cache->stats.in_use > cache->stats.peak) {
+        cache->stats.peak = cache->stats.in_use;
+    }
+
+    mutex_unlock(&cache->lock);
+
+    memset(object, 0, cache->object_size);
+    return object;
+}
+
+void slab_free(slab_cache_t *cache, void *object) {
+    if (!object) return;
+
+    mutex_lock(&cache->lock);
+    slab_object_t *free_object = (slab_object_t*)object;
+    free_object->next = cache->free_list;
+    cache->free_list = free_object;
+    cache->stats.frees++;
+    cache->stats.in_use--;
+    mutex_unlock(&cache->lock);
+}
+
+void slab_get_stats(slab_cache_t *cache, slab_stats_t *stats) {
+    mutex_lock(&cache->lock);
+    *stats = cache->stats;
+    mutex_unlock(&cache->lock);
+}
+
+void slab_log_stats(slab_cache_t *cache, const char *module) {
+    if (!cache->initialized) return;
+
+    slab_stats_t stats;
+    slab_get_stats(cache, &stats);
+    LOG_INFO(module, "%s slab: %d/%d in use (peak %d) in %d slabs of %zu-byte objects, %llu allocs",
+             cache->name, stats.in_use, stats.capacity, stats.peak, stats.slabs,
+             stats.object_size, (unsigned long long)stats.allocs);
+}
@@ -0,0 +1,173 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * thread.c - Portable mutex, condition variable and thread wrappers
+ */
+
+#include "thread.h"
+
+#ifdef _WIN32
+    #include <process.h>
+#endif
+
+/* Heap-allocated trampoline so the caller's func/arg outlive thread_create */
+typedef struct {
+    thread_func_t func;
+    void *arg;
+} thread_start_t;
+
+void mutex_init(mutex_t *mutex) {
+#ifdef _WIN32
+    InitializeCriticalSection(mutex);
+#else
+    pthread_mutex_init(mutex, NULL);
+#endif
+}
+
+void mutex_destroy(mutex_t *mutex) {
+#ifdef _WIN32
+    DeleteCriticalSection(mutex);
+#else
+    pthread_mutex_destroy(mutex);
+#endif
+}
+
+void mutex_lock(mutex_t *mutex) {
+#ifdef _WIN32
+    EnterCriticalSection(mutex);
+#else
+    pthread_mutex_lock(mutex);
+#endif
+}
+
+void mutex_unlock(mutex_t *mutex) {
+#ifdef _WIN32
+    LeaveCriticalSection(mutex);
+#else
+    pthread_mutex_unlock(mutex);
+#endif
+}
+
+void cond_init(cond_t *cond) {
+#ifdef _WIN32
+    InitializeConditionVariable(cond);
+#else
+    pthread_cond_init(cond, NULL);
+#endif
+}
+
+void cond_destroy(cond_t *cond) {
+#ifdef _WIN32
+    (void)cond;
+#else
+    pthread_cond_destroy(cond);
+#endif
+}
+
+void cond_wait(cond_t *cond, mutex_t *mutex) {
+#ifdef _WIN32
+    SleepConditionVariableCS(cond, mutex, INFINITE);
+#else
+    pthread_cond_wait(cond, mutex);
+#endif
+}
+
+void cond_timed_wait(cond_t *cond, mutex_t *mutex, uint32_t ms) {
+#ifdef _WIN32
+    SleepConditionVariableCS(cond, mutex, ms);
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    ts.tv_sec += ms / 1000;
+    ts.tv_nsec += (long)(ms % 1000) * 1000000L;
+    if (ts.tv_nsec >= 1000000000L) {
+        ts.tv_sec++;
+        ts.tv_nsec -= 1000000000L;
+    }
+    pthread_cond_timedwait(cond, mutex, &ts);
+#endif
+}
+
+void cond_signal(cond_t *cond) {
+#ifdef _WIN32
+    WakeConditionVariable(cond);
+#else
+    pthread_cond_signal(cond);
+#endif
+}
+
+void cond_broadcast(cond_t *cond) {
+#ifdef _WIN32
+    WakeAllConditionVariable(cond);
+#else
+    pthread_cond_broadcast(cond);
+#endif
+}
+
+#ifdef _WIN32
+static unsigned __stdcall thread_trampoline(void *arg) {
+    thread_start_t start = *(thread_start_t*)arg;
+    free(arg);
+    start.func(start.arg);
+    return 0;
+}
+#else
+static void *thread_trampoline(void *arg) {
+    thread_start_t start = *(thread_start_t*)arg;
+    free(arg);
+    start.func(start.arg);
+    return NULL;
+}
+#endif
+
+result_t thread_create(thread_t *thread, thread_func_t func, void *arg) {
+    thread_start_t *start = ALLOC(thread_start_t);
+    if (!start) return ERR_MEMORY;
+
+    start->func = func;
+    start->arg = arg;
+
+#ifdef _WIN32
+    *thread = (HANDLE)_beginthreadex(NULL, 0, thread_trampoline, start, 0, NULL);
+    if (*thread == NULL) {
+        free(start);
+        return ERR_MEMORY;
+    }
+#else
+    if (pthread_create(thread, NULL, thread_trampoline, start) != 0) {
+        free(start);
+        return ERR_MEMORY;
+    }
+#endif
+
+    return OK;
+}
+
+void thread_join(thread_t thread) {
+#ifdef _WIN32
+    WaitForSingleObject(thread, INFINITE);
+    CloseHandle(thread);
+#else
+    pthread_join(thread, NULL);
+#endif
+}
+
+void thread_detach(thread_t thread) {
+#ifdef _WIN32
+    CloseHandle(thread);
+#else
+    pthread_detach(thread);
+#endif
+}
+
+void thread_sleep_ms(uint32_t ms) {
+#ifdef _WIN32
+    Sleep(ms);
+#else
+    struct timespec ts;
+    ts.tv_sec = ms / 1000;
+    ts.tv_nsec = (long)(ms % 1000) * 1000000L;
+    nanosleep(&ts, NULL);
+#endif
+}
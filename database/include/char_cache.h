@@ -0,0 +1,65 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * char_cache.h - Resident character cache keyed by ID with an account index
+ */
+
+#ifndef CHAR_CACHE_H
+#define CHAR_CACHE_H
+
+#include "common.h"
+#include "models.h"
+
+/* Initial bucket count of each hash table (power of two) */
+#define CHAR_CACHE_INITIAL_BUCKETS 256
+
+/* Cache counters */
+typedef struct {
+    uint64_t hits;            /* Character lookups served from memory */
+    uint64_t misses;
+    uint64_t account_hits;    /* Character lists served from memory */
+    uint64_t account_misses;
+    uint32_t characters;      /* Characters resident */
+    uint32_t accounts;        /* Accounts indexed */
+} char_cache_stats_t;
+
+/* Set up / tear down the cache (database_init and database_shutdown do this) */
+result_t char_cache_init(void);
+void char_cache_shutdown(void);
+
+/* Copy a cached character, false on a miss */
+bool char_cache_get(int character_id, character_t *character);
+
+/* Removal generation: read it before going to storage and pass it back with
+ * the rows, which are then dropped if a character was removed meanwhile */
+uint32_t char_cache_generation(void);
+
+/* Add a character just written to storage. An entry that is already
+ * cached wins, since it may hold changes not yet committed. */
+void char_cache_put(const character_t *character);
+
+/* Add a character read from storage, unless a removal since generation
+ * may have deleted it */
+void char_cache_load(const character_t *character, uint32_t generation);
+
+/* Append an account's characters (by ascending ID) to list, false if the
+ * account has not been loaded yet or the list could not grow */
+bool char_cache_get_account(int account_id, character_list_t *list);
+
+/* Take an account's characters as loaded from storage and mark the
+ * account complete. list is then refilled from the cache, whose copies
+ * may be newer than the rows read. Rows read before a removal since
+ * generation are left uncached. Fails if list could not be refilled. */
+result_t char_cache_load_account(int account_id, uint32_t generation, character_list_t *list);
+
+/* Update a cached character's position (no-op if it is not cached) */
+void char_cache_update_position(int character_id, int map, float x, float y, float z, float orientation);
+
+/* Drop a character */
+void char_cache_remove(int character_id);
+
+/* Get counters */
+void char_cache_get_stats(char_cache_stats_t *stats);
+
+#endif /* CHAR_CACHE_H */
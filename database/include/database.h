@@ -2,7 +2,7 @@
  * AshEmu - WoW 2.4.3 Server Emulator
  * Copyright (C) 2025 AshEmu Team
  *
- * database.h - SQLite database wrapper
+ * database.h - Account and character storage
  */
 
 #ifndef DATABASE_H
@@ -10,35 +10,89 @@
 
 #include "common.h"
 #include "models.h"
-#include <sqlite3.h>
+#include "thread.h"
+#include "db_writer.h"
+#include "storage.h"
 
-/* Database context */
+/* SQLite journal modes a profile can select */
+typedef enum {
+    DB_JOURNAL_DELETE,  /* Rollback journal (SQLite default) */
+    DB_JOURNAL_WAL      /* Write-ahead log: readers don't block on writers */
+} db_journal_mode_t;
+
+/* PRAGMA synchronous levels (values match SQLite's) */
+typedef enum {
+    DB_SYNC_OFF = 0,
+    DB_SYNC_NORMAL = 1,  /* With WAL: fsync at checkpoints only */
+    DB_SYNC_FULL = 2     /* fsync on every commit */
+} db_synchronous_t;
+
+/* Storage profile, applied to every connection when it is opened */
 typedef struct {
-    sqlite3 *db;
-    char path[MAX_PATH];
-} database_t;
+    const char *name;
+    db_journal_mode_t journal_mode;
+    db_synchronous_t synchronous;
+    int64_t mmap_size;       /* Bytes of the file to memory-map (0 = off) */
+    int cache_size_kb;       /* Page cache per connection */
+    bool temp_store_memory;  /* Temporary tables and indices in RAM */
+} db_profile_t;
+
+/* Built-in profiles */
+typedef enum {
+    DB_PROFILE_LEGACY,    /* Rollback journal, synchronous=FULL, no mmap */
+    DB_PROFILE_DURABLE,   /* WAL, synchronous=FULL */
+    DB_PROFILE_BALANCED,  /* WAL, synchronous=NORMAL (default) */
+    DB_PROFILE_COUNT
+} db_profile_id_t;
+
+/* Get a built-in profile */
+result_t database_profile_get(db_profile_id_t id, db_profile_t *profile);
+
+/* Find a built-in profile by name */
+result_t database_profile_find(const char *name, db_profile_t *profile);
 
-/* Global database instance (singleton pattern) */
-extern database_t *g_database;
+/* Set the profile the SQLite backend uses from the next database_init */
+result_t database_set_profile(const db_profile_t *profile);
+void database_get_profile(db_profile_t *profile);
 
-/* Initialize database (creates tables if needed) */
+/* Set the backend used by the next database_init (SQLite by default) */
+void database_set_backend(const storage_backend_t *backend);
+const storage_backend_t *database_get_backend(void);
+
+/* Initialize database (path is the backend's: the SQLite file, say) */
 result_t database_init(const char *db_path);
 
 /* Shutdown database */
 void database_shutdown(void);
 
+/* Release the calling thread's storage resources, such as its SQLite
+ * reader connection (call before a thread that used the database exits) */
+void database_thread_release(void);
+
+/* Writes below go through the writer thread (db_writer.h) and return
+ * once committed */
+
 /* Account operations */
 result_t database_get_account(const char *username, account_t *account);
 result_t database_create_account(const char *username, const uint8_t salt[SRP6_SALT_SIZE],
                                          const uint8_t verifier[SRP6_VERIFIER_SIZE], account_t *account);
 result_t database_update_session_key(int account_id, const uint8_t session_key[SRP6_SESSION_KEY_SIZE]);
 
-/* Character operations */
+/* Character operations (the list must already be initialized) */
 result_t database_get_characters(int account_id, character_list_t *list);
 result_t database_get_character(int character_id, character_t *character);
 result_t database_character_name_exists(const char *name, bool *exists);
+result_t database_get_character_name(int character_id, character_name_t *name);
 result_t database_create_character(character_t *character);
 result_t database_update_character_position(int character_id, int map, float x, float y, float z, float orientation);
+/* Queue a position save without waiting for it to commit */
+result_t database_save_character_position(int character_id, int map, float x, float y, float z, float orientation);
 result_t database_delete_character(int character_id);
 
+/* Writer transaction on the backend: begin, apply one write at a time,
+ * commit (rolling back on failure) */
+result_t database_write_begin(void);
+result_t database_write_apply(db_write_t *write);
+result_t database_write_commit(void);
+
 #endif /* DATABASE_H */
@@ -0,0 +1,89 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * db_writer.h - Single database writer thread with group commit
+ */
+
+#ifndef DB_WRITER_H
+#define DB_WRITER_H
+
+#include "common.h"
+#include "models.h"
+
+/* Longest a queued write waits before its batch is committed */
+#define DB_WRITER_COMMIT_MS 10
+
+/* Most writes committed in one transaction */
+#define DB_WRITER_MAX_BATCH 1024
+
+/* Write operations */
+typedef enum {
+    DB_WRITE_BARRIER,           /* No-op: completes once everything before it has */
+    DB_WRITE_CREATE_ACCOUNT,
+    DB_WRITE_SESSION_KEY,
+    DB_WRITE_CREATE_CHARACTER,
+    DB_WRITE_POSITION,
+    DB_WRITE_DELETE_CHARACTER
+} db_write_type_t;
+
+typedef struct db_write db_write_t;
+
+/* Called on the writer thread once the write's transaction has committed
+ * (or failed); the write is freed when the callback returns */
+typedef void (*db_write_callback_t)(const db_write_t *write, void *ctx);
+
+/* One queued write */
+struct db_write {
+    db_write_t *volatile next;  /* Queue link */
+    db_write_type_t type;
+    union {
+        account_t account;      /* Create account: id is filled in on commit */
+        struct {
+            int account_id;
+            uint8_t key[SRP6_SESSION_KEY_SIZE];
+        } session_key;
+        character_t character;  /* Create character: id is filled in on commit */
+        struct {
+            int character_id;
+            int map;
+            float x, y, z, orientation;
+        } position;
+        int character_id;       /* Delete character */
+    };
+    result_t result;
+    db_write_callback_t callback;
+    void *callback_ctx;
+    bool heap;                  /* Copied by db_writer_submit, freed after completion */
+    volatile bool done;         /* Set for db_writer_execute waiters */
+};
+
+/* Writer counters */
+typedef struct {
+    uint64_t writes;     /* Writes committed or failed */
+    uint64_t batches;    /* Transactions (one fsync each) */
+    uint64_t failed;     /* Writes that returned an error */
+    uint32_t max_batch;  /* Largest transaction */
+} db_writer_stats_t;
+
+/* Start the writer thread (database_init does this) */
+result_t db_writer_start(uint32_t commit_interval_ms);
+
+/* Commit everything still queued and stop the writer thread */
+void db_writer_stop(void);
+
+/* Queue a copy of a write; the callback (optional) fires after commit and
+ * must not queue further writes */
+result_t db_writer_submit(const db_write_t *write, db_write_callback_t callback, void *ctx);
+
+/* Queue a write, wake the writer and wait for its commit. Runs the write
+ * directly when the writer thread is not running. */
+result_t db_writer_execute(db_write_t *write);
+
+/* Wait until every write queued before this call has committed */
+void db_writer_flush(void);
+
+/* Get writer counters */
+void db_writer_get_stats(db_writer_stats_t *stats);
+
+#endif /* DB_WRITER_H */
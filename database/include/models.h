@@ -10,6 +10,7 @@
 
 #include "common.h"
 #include "crypto.h"
+#include "arena.h"
 
 /* Account structure */
 typedef struct {
@@ -42,11 +43,21 @@ typedef struct {
     float orientation;
 } character_t;
 
+/* What a name query answers about a character */
+typedef struct {
+    int id;
+    char name[MAX_CHARACTER_NAME + 1];
+    uint8_t race;
+    uint8_t char_class;
+    uint8_t gender;
+} character_name_t;
+
 /* Character list (dynamic array) */
 typedef struct {
     character_t *items;
     int count;
     int capacity;
+    arena_t *arena;  /* Items come from this arena if set */
 } character_list_t;
 
 /* Initialize account structure */
@@ -58,6 +69,9 @@ void character_init(character_t *character);
 /* Initialize character list */
 void character_list_init(character_list_t *list);
 
+/* Initialize character list backed by an arena (freed with the arena) */
+void character_list_init_arena(character_list_t *list, arena_t *arena);
+
 /* Free character list */
 void character_list_free(character_list_t *list);
 
@@ -0,0 +1,45 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * name_index.h - Resident index of every character name
+ */
+
+#ifndef NAME_INDEX_H
+#define NAME_INDEX_H
+
+#include "common.h"
+#include "models.h"
+
+/* Minimum bucket count of each hash table (power of two) */
+#define NAME_INDEX_MIN_BUCKETS 1024
+
+/* Index counters */
+typedef struct {
+    uint64_t name_checks;  /* Uniqueness checks */
+    uint64_t lookups;      /* GUID lookups */
+    uint64_t misses;       /* GUID lookups for unknown characters */
+    uint32_t names;        /* Characters indexed */
+} name_index_stats_t;
+
+/* Set up the index sized for about expected names / tear it down */
+result_t name_index_init(uint32_t expected);
+void name_index_shutdown(void);
+
+/* Add characters, skipping any whose name or ID is already indexed.
+ * Returns how many were added. */
+int name_index_add(const character_name_t *names, int count);
+
+/* Drop a character */
+void name_index_remove(int character_id);
+
+/* Check if a name is taken, ignoring ASCII case like COLLATE NOCASE */
+bool name_index_exists(const char *name);
+
+/* Copy a character's name entry, false if there is none */
+bool name_index_get(int character_id, character_name_t *name);
+
+/* Get counters */
+void name_index_get_stats(name_index_stats_t *stats);
+
+#endif /* NAME_INDEX_H */
@@ -0,0 +1,60 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * storage.h - Storage backend interface
+ */
+
+#ifndef STORAGE_H
+#define STORAGE_H
+
+#include "common.h"
+#include "models.h"
+
+/* Receives the characters of get_character_names, one at a time */
+typedef void (*storage_name_fn)(const character_name_t *name, void *ctx);
+
+/* Where accounts and characters are kept. database.c puts the character
+ * cache, name index and writer thread in front of it: reads come from any
+ * thread, writes only from the writer thread between write_begin and
+ * write_commit. */
+typedef struct {
+    const char *name;
+
+    /* Open the store (path is backend-specific) / close it */
+    result_t (*open)(const char *path);
+    void (*close)(void);
+
+    /* Release the calling thread's resources before it exits */
+    void (*thread_release)(void);
+
+    /* Reads; get_characters appends to list */
+    result_t (*get_account)(const char *username, account_t *account);
+    result_t (*get_characters)(int account_id, character_list_t *list);
+    result_t (*get_character)(int character_id, character_t *character);
+
+    /* Count characters and the ID range they span, then pass the names of
+     * those in [first_id, last_id] to fn (the name index is loaded this way) */
+    result_t (*character_id_range)(int *count, int *first_id, int *last_id);
+    result_t (*get_character_names)(int first_id, int last_id, storage_name_fn fn, void *ctx);
+
+    /* Writes; the creates fill in the new ID */
+    result_t (*write_begin)(void);
+    result_t (*create_account)(account_t *account);
+    result_t (*update_session_key)(int account_id, const uint8_t session_key[SRP6_SESSION_KEY_SIZE]);
+    result_t (*create_character)(character_t *character);
+    result_t (*update_character_position)(int character_id, int map, float x, float y, float z, float orientation);
+    result_t (*delete_character)(int character_id);
+    result_t (*write_commit)(void);  /* Rolls back on failure */
+} storage_backend_t;
+
+/* SQLite file (storage_sqlite.c) */
+extern const storage_backend_t storage_sqlite;
+
+/* Hash tables in memory, gone at shutdown (storage_memory.c) */
+extern const storage_backend_t storage_memory;
+
+/* Find a backend by name ("sqlite", "memory") */
+const storage_backend_t *storage_backend_find(const char *name);
+
+#endif /* STORAGE_H */
@@ -0,0 +1,59 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * storage_sqlite.h - SQLite storage backend internals
+ */
+
+#ifndef STORAGE_SQLITE_H
+#define STORAGE_SQLITE_H
+
+#include "database.h"
+#include <sqlite3.h>
+
+/* Statements prepared once per connection. Reads come first: reader
+ * connections only prepare those. */
+typedef enum {
+    DB_STMT_GET_ACCOUNT,
+    DB_STMT_GET_CHARACTERS,
+    DB_STMT_GET_CHARACTER,
+    DB_STMT_CHARACTER_ID_RANGE,
+    DB_STMT_GET_CHARACTER_NAMES,
+    DB_STMT_READ_COUNT,
+    DB_STMT_CREATE_ACCOUNT = DB_STMT_READ_COUNT,
+    DB_STMT_UPDATE_SESSION_KEY,
+    DB_STMT_CREATE_CHARACTER,
+    DB_STMT_UPDATE_POSITION,
+    DB_STMT_DELETE_CHARACTER,
+    DB_STMT_BEGIN,
+    DB_STMT_COMMIT,
+    DB_STMT_ROLLBACK,
+    DB_STMT_COUNT
+} db_statement_t;
+
+/* Read-only connection, owned by one thread at a time */
+typedef struct db_connection {
+    sqlite3 *db;
+    sqlite3_stmt *statements[DB_STMT_READ_COUNT];
+    struct db_connection *next;       /* All reader connections */
+    struct db_connection *next_idle;  /* Idle list */
+} db_connection_t;
+
+/* Database context. db is the single writer connection, used by the
+ * writer thread under lock; each reading thread gets a read-only
+ * connection of its own from the pool. */
+typedef struct {
+    sqlite3 *db;
+    char path[MAX_PATH];
+    mutex_t lock;
+    sqlite3_stmt *statements[DB_STMT_COUNT];
+    mutex_t pool_lock;
+    db_connection_t *readers;
+    db_connection_t *idle;   /* Handed back by threads that finished */
+    int reader_count;
+} database_t;
+
+/* The open SQLite database */
+extern database_t *g_database;
+
+#endif /* STORAGE_SQLITE_H */
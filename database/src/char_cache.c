@@ -0,0 +1,359 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * char_cache.c - Resident character cache keyed by ID with an account index
+ *
+ * Two chained hash tables: characters by ID, and accounts by ID with each
+ * account's characters linked in ascending ID order. Characters come in as
+ * they are first read and stay; an account is marked loaded once its full
+ * list has been read, after which character screens never go to storage.
+ * Writes update the cache before they are queued, so it is always at least
+ * as new as the database. Every removal bumps a generation so rows read
+ * before a delete committed can't bring the character back.
+ */
+
+#include "char_cache.h"
+#include "thread.h"
+
+typedef struct char_entry {
+    character_t character;
+    struct char_entry *next;          /* ID bucket chain */
+    struct char_entry *next_account;  /* Account's characters, ascending ID */
+} char_entry_t;
+
+typedef struct account_entry {
+    int account_id;
+    bool loaded;                      /* Every character of the account is cached */
+    char_entry_t *characters;
+    struct account_entry *next;       /* Bucket chain */
+} account_entry_t;
+
+static mutex_t g_lock;
+static bool g_initialized = false;
+
+static char_entry_t **g_characters = NULL;
+static uint32_t g_character_mask = 0;
+
+static account_entry_t **g_accounts = NULL;
+static uint32_t g_account_mask = 0;
+
+static char_cache_stats_t g_stats;
+static uint32_t g_generation = 0;  /* Bumped by every removal */
+
+static uint32_t hash_id(int id) {
+    uint32_t h = (uint32_t)id * 2654435761u;
+    return h ^ (h >> 16);
+}
+
+static char_entry_t *find_character(int character_id) {
+    char_entry_t *entry = g_characters[hash_id(character_id) & g_character_mask];
+    while (entry && entry->character.id != character_id) {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+static account_entry_t *find_account(int account_id) {
+    account_entry_t *entry = g_accounts[hash_id(account_id) & g_account_mask];
+    while (entry && entry->account_id != account_id) {
+        entry = entry->next;
+    }
+    return entry;
+}
+
+/* Double a table once it holds more entries than buckets */
+static void grow_characters(void) {
+    if (g_stats.characters <= g_character_mask) return;
+
+    uint32_t mask = g_character_mask * 2 + 1;
+    char_entry_t **buckets = ALLOC_ARRAY(char_entry_t*, mask + 1);
+    if (!buckets) return;
+
+    for (uint32_t i = 0; i <= g_character_mask; i++) {
+        for (char_entry_t *entry = g_characters[i], *next; entry; entry = next) {
+            next = entry->next;
+            uint32_t b = hash_id(entry->character.id) & mask;
+            entry->next = buckets[b];
+            buckets[b] = entry;
+        }
+    }
+    free(g_characters);
+    g_characters = buckets;
+    g_character_mask = mask;
+}
+
+static void grow_accounts(void) {
+    if (g_stats.accounts <= g_account_mask) return;
+
+    uint32_t mask = g_account_mask * 2 + 1;
+    account_entry_t **buckets = ALLOC_ARRAY(account_entry_t*, mask + 1);
+    if (!buckets) return;
+
+    for (uint32_t i = 0; i <= g_account_mask; i++) {
+        for (account_entry_t *entry = g_accounts[i], *next; entry; entry = next) {
+            next = entry->next;
+            uint32_t b = hash_id(entry->account_id) & mask;
+            entry->next = buckets[b];
+            buckets[b] = entry;
+        }
+    }
+    free(g_accounts);
+    g_accounts = buckets;
+    g_account_mask = mask;
+}
+
+static account_entry_t *get_or_add_account(int account_id) {
+    account_entry_t *account = find_account(account_id);
+    if (account) return account;
+
+    account = ALLOC(account_entry_t);
+    if (!account) return NULL;
+
+    account->account_id = account_id;
+    uint32_t b = hash_id(account_id) & g_account_mask;
+    account->next = g_accounts[b];
+    g_accounts[b] = account;
+    g_stats.accounts++;
+    grow_accounts();
+    return account;
+}
+
+/* Insert a character that is not cached yet */
+static char_entry_t *add_character(const character_t *character) {
+    account_entry_t *account = get_or_add_account(character->account_id);
+    if (!account) return NULL;
+
+    char_entry_t *entry = ALLOC(char_entry_t);
+    if (!entry) return NULL;
+
+    entry->character = *character;
+    uint32_t b = hash_id(character->id) & g_character_mask;
+    entry->next = g_characters[b];
+    g_characters[b] = entry;
+
+    char_entry_t **link = &account->characters;
+    while (*link && (*link)->character.id < character->id) {
+        link = &(*link)->next_account;
+    }
+    entry->next_account = *link;
+    *link = entry;
+
+    g_stats.characters++;
+    grow_characters();
+    return entry;
+}
+
+static void free_tables(void) {
+    for (uint32_t i = 0; i <= g_character_mask; i++) {
+        for (char_entry_t *entry = g_characters[i], *next; entry; entry = next) {
+            next = entry->next;
+            free(entry);
+        }
+    }
+    for (uint32_t i = 0; i <= g_account_mask; i++) {
+        for (account_entry_t *entry = g_accounts[i], *next; entry; entry = next) {
+            next = entry->next;
+            free(entry);
+        }
+    }
+    FREE(g_characters);
+    FREE(g_accounts);
+}
+
+result_t char_cache_init(void) {
+    if (g_initialized) return ERR_ALREADY_EXISTS;
+
+    g_characters = ALLOC_ARRAY(char_entry_t*, CHAR_CACHE_INITIAL_BUCKETS);
+    g_accounts = ALLOC_ARRAY(account_entry_t*, CHAR_CACHE_INITIAL_BUCKETS);
+    if (!g_characters || !g_accounts) {
+        FREE(g_characters);
+        FREE(g_accounts);
+        return ERR_MEMORY;
+    }
+    g_character_mask = CHAR_CACHE_INITIAL_BUCKETS - 1;
+    g_account_mask = CHAR_CACHE_INITIAL_BUCKETS - 1;
+    memset(&g_stats, 0, sizeof(g_stats));
+
+    mutex_init(&g_lock);
+    g_initialized = true;
+    return OK;
+}
+
+void char_cache_shutdown(void) {
+    if (!g_initialized) return;
+
+    LOG_INFO("Database", "Character cache: %u characters, %u accounts, %llu/%llu hits, %llu/%llu list hits",
+             g_stats.characters, g_stats.accounts,
+             (unsigned long long)g_stats.hits, (unsigned long long)(g_stats.hits + g_stats.misses),
+             (unsigned long long)g_stats.account_hits,
+             (unsigned long long)(g_stats.account_hits + g_stats.account_misses));
+
+    g_initialized = false;
+    free_tables();
+    mutex_destroy(&g_lock);
+}
+
+bool char_cache_get(int character_id, character_t *character) {
+    if (!g_initialized) return false;
+
+    mutex_lock(&g_lock);
+    char_entry_t *entry = find_character(character_id);
+    if (entry) {
+        *character = entry->character;
+        g_stats.hits++;
+    } else {
+        g_stats.misses++;
+    }
+    mutex_unlock(&g_lock);
+    return entry != NULL;
+}
+
+uint32_t char_cache_generation(void) {
+    if (!g_initialized) return 0;
+
+    mutex_lock(&g_lock);
+    uint32_t generation = g_generation;
+    mutex_unlock(&g_lock);
+    return generation;
+}
+
+void char_cache_load(const character_t *character, uint32_t generation) {
+    if (!g_initialized) return;
+
+    mutex_lock(&g_lock);
+    if (generation == g_generation && !find_character(character->id)) {
+        add_character(character);
+    }
+    mutex_unlock(&g_lock);
+}
+
+void char_cache_put(const character_t *character) {
+    if (!g_initialized) return;
+
+    mutex_lock(&g_lock);
+    if (!find_character(character->id)) {
+        add_character(character);
+    }
+    mutex_unlock(&g_lock);
+}
+
+bool char_cache_get_account(int account_id, character_list_t *list) {
+    if (!g_initialized) return false;
+
+    mutex_lock(&g_lock);
+    account_entry_t *account = find_account(account_id);
+    bool loaded = account && account->loaded;
+    if (loaded) {
+        int start = list->count;
+        for (char_entry_t *entry = account->characters; entry; entry = entry->next_account) {
+            if (character_list_add(list, &entry->character) != OK) {
+                /* Let the caller read storage rather than see a short list */
+                list->count = start;
+                loaded = false;
+                break;
+            }
+        }
+    }
+    if (loaded) {
+        g_stats.account_hits++;
+    } else {
+        g_stats.account_misses++;
+    }
+    mutex_unlock(&g_lock);
+    return loaded;
+}
+
+result_t char_cache_load_account(int account_id, uint32_t generation, character_list_t *list) {
+    if (!g_initialized) return OK;
+
+    mutex_lock(&g_lock);
+    if (generation != g_generation) {
+        /* A row may belong to a character deleted since; leave it to storage */
+        mutex_unlock(&g_lock);
+        return OK;
+    }
+
+    result_t result = OK;
+    bool complete = true;
+    for (int i = 0; i < list->count; i++) {
+        char_entry_t *entry = find_character(list->items[i].id);
+        if (entry) {
+            list->items[i] = entry->character;
+        } else if (!add_character(&list->items[i])) {
+            complete = false;
+        }
+    }
+
+    /* Only serve the list from memory if every row made it in; it then
+     * also picks up characters created since the rows were read */
+    account_entry_t *account = get_or_add_account(account_id);
+    if (account && complete) {
+        account->loaded = true;
+        list->count = 0;
+        for (char_entry_t *entry = account->characters; entry && result == OK; entry = entry->next_account) {
+            result = character_list_add(list, &entry->character);
+        }
+    }
+    mutex_unlock(&g_lock);
+    return result;
+}
+
+void char_cache_update_position(int character_id, int map, float x, float y, float z, float orientation) {
+    if (!g_initialized) return;
+
+    mutex_lock(&g_lock);
+    char_entry_t *entry = find_character(character_id);
+    if (entry) {
+        entry->character.map = map;
+        entry->character.x = x;
+        entry->character.y = y;
+        entry->character.z = z;
+        entry->character.orientation = orientation;
+    }
+    mutex_unlock(&g_lock);
+}
+
+void char_cache_remove(int character_id) {
+    if (!g_initialized) return;
+
+    mutex_lock(&g_lock);
+    /* Even if it is not cached, a reader may be about to add it */
+    g_generation++;
+
+    char_entry_t **link = &g_characters[hash_id(character_id) & g_character_mask];
+    while (*link && (*link)->character.id != character_id) {
+        link = &(*link)->next;
+    }
+
+    char_entry_t *entry = *link;
+    if (entry) {
+        *link = entry->next;
+
+        account_entry_t *account = find_account(entry->character.account_id);
+        if (account) {
+            char_entry_t **account_link = &account->characters;
+            while (*account_link && *account_link != entry) {
+                account_link = &(*account_link)->next_account;
+            }
+            if (*account_link) {
+                *account_link = entry->next_account;
+            }
+        }
+
+        free(entry);
+        g_stats.characters--;
+    }
+    mutex_unlock(&g_lock);
+}
+
+void char_cache_get_stats(char_cache_stats_t *stats) {
+    if (!g_initialized) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    mutex_lock(&g_lock);
+    *stats = g_stats;
+    mutex_unlock(&g_lock);
+}
@@ -2,392 +2,309 @@
  * AshEmu - WoW 2.4.3 Server Emulator
  * Copyright (C) 2025 AshEmu Team
  *
- * database.c - SQLite database implementation
+ * database.c - Account and character storage
+ *
+ * The public calls in front of the storage backend: characters are served
+ * from the character cache and names from the name index, and writes are
+ * queued on the writer thread, which applies them to the backend in
+ * batches between database_write_begin and database_write_commit.
  */
 
 #include "database.h"
+#include "char_cache.h"
+#include "name_index.h"
 
-/* Global database instance */
-database_t *g_database = NULL;
-
-/* SQL for creating tables */
-static const char *CREATE_TABLES_SQL =
-    "CREATE TABLE IF NOT EXISTS accounts ("
-    "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
-    "    username TEXT NOT NULL UNIQUE COLLATE NOCASE,"
-    "    salt BLOB NOT NULL,"
-    "    verifier BLOB NOT NULL,"
-    "    session_key BLOB"
-    ");"
-    ""
-    "CREATE TABLE IF NOT EXISTS characters ("
-    "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
-    "    account_id INTEGER NOT NULL,"
-    "    name TEXT NOT NULL UNIQUE COLLATE NOCASE,"
-    "    race INTEGER NOT NULL,"
-    "    class INTEGER NOT NULL,"
-    "    gender INTEGER NOT NULL,"
-    "    skin INTEGER DEFAULT 0,"
-    "    face INTEGER DEFAULT 0,"
-    "    hair_style INTEGER DEFAULT 0,"
-    "    hair_color INTEGER DEFAULT 0,"
-    "    facial_hair INTEGER DEFAULT 0,"
-    "    level INTEGER DEFAULT 1,"
-    "    map INTEGER DEFAULT 0,"
-    "    x REAL NOT NULL,"
-    "    y REAL NOT NULL,"
-    "    z REAL NOT NULL,"
-    "    orientation REAL DEFAULT 0,"
-    "    FOREIGN KEY (account_id) REFERENCES accounts(id)"
-    ");";
+/* Threads loading the name index at startup, each over its own ID range */
+#define NAME_LOAD_THREADS 4
 
-result_t database_init(const char *db_path) {
-    if (g_database) {
-        return ERR_ALREADY_EXISTS;
-    }
+/* Below this many characters the name index is loaded on one thread */
+#define NAME_LOAD_PARALLEL_MIN 65536
 
-    g_database = ALLOC(database_t);
-    if (!g_database) return ERR_MEMORY;
+/* Rows handed to the name index at a time */
+#define NAME_LOAD_BATCH 512
 
-    safe_strncpy(g_database->path, db_path, sizeof(g_database->path));
+static const storage_backend_t *g_backend = &storage_sqlite;
+static bool g_open = false;
 
-    int rc = sqlite3_open(db_path, &g_database->db);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to open database: %s", sqlite3_errmsg(g_database->db));
-        FREE(g_database);
-        return ERR_DATABASE;
-    }
+static const storage_backend_t *BACKENDS[] = { &storage_sqlite, &storage_memory };
 
-    /* Create tables */
-    char *err_msg = NULL;
-    rc = sqlite3_exec(g_database->db, CREATE_TABLES_SQL, NULL, NULL, &err_msg);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to create tables: %s", err_msg);
-        sqlite3_free(err_msg);
-        sqlite3_close(g_database->db);
-        FREE(g_database);
-        return ERR_DATABASE;
+const storage_backend_t *storage_backend_find(const char *name) {
+    for (size_t i = 0; i < sizeof(BACKENDS) / sizeof(BACKENDS[0]); i++) {
+        if (strcmp(BACKENDS[i]->name, name) == 0) {
+            return BACKENDS[i];
+        }
     }
+    return NULL;
+}
 
-    LOG_INFO("Database", "Initialized");
-    return OK;
+void database_set_backend(const storage_backend_t *backend) {
+    g_backend = backend;
 }
 
-void database_shutdown(void) {
-    if (g_database) {
-        if (g_database->db) {
-            sqlite3_close(g_database->db);
-        }
-        FREE(g_database);
+const storage_backend_t *database_get_backend(void) {
+    return g_backend;
+}
+
+void database_thread_release(void) {
+    if (g_open) {
+        g_backend->thread_release();
     }
 }
 
-result_t database_get_account(const char *username, account_t *account) {
-    account_init(account);
+/* One loader's share of the character IDs */
+typedef struct {
+    thread_t thread;
+    int first_id;
+    int last_id;
+    int loaded;
+    character_name_t batch[NAME_LOAD_BATCH];
+    int count;
+} name_load_t;
+
+static void load_name(const character_name_t *name, void *ctx) {
+    name_load_t *load = (name_load_t*)ctx;
+    load->batch[load->count++] = *name;
+    if (load->count == NAME_LOAD_BATCH) {
+        load->loaded += name_index_add(load->batch, load->count);
+        load->count = 0;
+    }
+}
 
-    const char *sql = "SELECT id, username, salt, verifier, session_key FROM accounts WHERE username = ? COLLATE NOCASE";
+static void load_name_range(void *arg) {
+    name_load_t *load = (name_load_t*)arg;
+    g_backend->get_character_names(load->first_id, load->last_id, load_name, load);
+    load->loaded += name_index_add(load->batch, load->count);
+    load->count = 0;
+    database_thread_release();
+}
 
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
-    }
+/* Read every character name into the index, splitting the ID range over
+ * several threads for large tables (SQLite gives each its own reader) */
+static result_t load_name_index(void) {
+    uint64_t start = get_time_us();
 
-    sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
+    int total = 0, first_id = 0, last_id = 0;
+    result_t result = g_backend->character_id_range(&total, &first_id, &last_id);
+    if (result != OK) return result;
 
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        account->id = sqlite3_column_int(stmt, 0);
-        safe_strncpy(account->username, (const char*)sqlite3_column_text(stmt, 1), sizeof(account->username));
+    result = name_index_init((uint32_t)total);
+    if (result != OK) return result;
 
-        const void *salt = sqlite3_column_blob(stmt, 2);
-        int salt_size = sqlite3_column_bytes(stmt, 2);
-        if (salt && salt_size == SRP6_SALT_SIZE) {
-            memcpy(account->salt, salt, SRP6_SALT_SIZE);
-        }
+    int threads = total >= NAME_LOAD_PARALLEL_MIN ? NAME_LOAD_THREADS : 1;
 
-        const void *verifier = sqlite3_column_blob(stmt, 3);
-        int verifier_size = sqlite3_column_bytes(stmt, 3);
-        if (verifier && verifier_size == SRP6_VERIFIER_SIZE) {
-            memcpy(account->verifier, verifier, SRP6_VERIFIER_SIZE);
-        }
+    name_load_t loads[NAME_LOAD_THREADS];
+    int64_t span = (int64_t)last_id - first_id + 1;
+    for (int i = 0; i < threads; i++) {
+        loads[i].first_id = (int)(first_id + span * i / threads);
+        loads[i].last_id = (int)(first_id + span * (i + 1) / threads - 1);
+        loads[i].loaded = 0;
+        loads[i].count = 0;
+    }
 
-        const void *session_key = sqlite3_column_blob(stmt, 4);
-        int session_key_size = sqlite3_column_bytes(stmt, 4);
-        if (session_key && session_key_size == SRP6_SESSION_KEY_SIZE) {
-            memcpy(account->session_key, session_key, SRP6_SESSION_KEY_SIZE);
-            account->has_session_key = true;
+    bool started[NAME_LOAD_THREADS] = { false };
+    for (int i = 1; i < threads; i++) {
+        started[i] = thread_create(&loads[i].thread, load_name_range, &loads[i]) == OK;
+    }
+    load_name_range(&loads[0]);
+
+    int loaded = loads[0].loaded;
+    for (int i = 1; i < threads; i++) {
+        if (started[i]) {
+            thread_join(loads[i].thread);
+        } else {
+            load_name_range(&loads[i]);
         }
+        loaded += loads[i].loaded;
+    }
 
-        sqlite3_finalize(stmt);
-        return OK;
+    if (loaded != total) {
+        LOG_ERROR("Database", "Name index holds %d of %d characters", loaded, total);
+        return ERR_DATABASE;
     }
 
-    sqlite3_finalize(stmt);
-    return ERR_NOT_FOUND;
+    LOG_INFO("Database", "Name index: %d characters in %llu ms on %d threads",
+             loaded, (unsigned long long)((get_time_us() - start) / 1000), threads);
+    return OK;
 }
 
-result_t database_create_account(const char *username, const uint8_t salt[SRP6_SALT_SIZE],
-                                         const uint8_t verifier[SRP6_VERIFIER_SIZE], account_t *account) {
-    const char *sql = "INSERT INTO accounts (username, salt, verifier) VALUES (?, ?, ?)";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
+result_t database_init(const char *db_path) {
+    if (g_open) {
+        return ERR_ALREADY_EXISTS;
     }
 
-    sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
-    sqlite3_bind_blob(stmt, 2, salt, SRP6_SALT_SIZE, SQLITE_STATIC);
-    sqlite3_bind_blob(stmt, 3, verifier, SRP6_VERIFIER_SIZE, SQLITE_STATIC);
+    result_t result = g_backend->open(db_path);
+    if (result != OK) return result;
+    g_open = true;
 
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    char_cache_init();
 
-    if (rc != SQLITE_DONE) {
-        LOG_ERROR("Database", "Failed to create account: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
+    result = load_name_index();
+    if (result != OK) {
+        database_shutdown();
+        return result;
     }
 
-    /* Fill in account struct */
-    account_init(account);
-    account->id = (int)sqlite3_last_insert_rowid(g_database->db);
-    safe_strncpy(account->username, username, sizeof(account->username));
-    memcpy(account->salt, salt, SRP6_SALT_SIZE);
-    memcpy(account->verifier, verifier, SRP6_VERIFIER_SIZE);
+    if (db_writer_start(DB_WRITER_COMMIT_MS) != OK) {
+        LOG_ERROR("Database", "Failed to start writer thread, writing inline");
+    }
 
+    LOG_INFO("Database", "Initialized (%s storage)", g_backend->name);
     return OK;
 }
 
-result_t database_update_session_key(int account_id, const uint8_t session_key[SRP6_SESSION_KEY_SIZE]) {
-    const char *sql = "UPDATE accounts SET session_key = ? WHERE id = ?";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
-    }
+void database_shutdown(void) {
+    if (!g_open) return;
 
-    sqlite3_bind_blob(stmt, 1, session_key, SRP6_SESSION_KEY_SIZE, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 2, account_id);
+    db_writer_stop();
+    char_cache_shutdown();
 
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
+    name_index_stats_t names;
+    name_index_get_stats(&names);
+    LOG_INFO("Database", "Name index: %u names, %llu name checks, %llu lookups (%llu unknown)",
+             names.names, (unsigned long long)names.name_checks,
+             (unsigned long long)names.lookups, (unsigned long long)names.misses);
+    name_index_shutdown();
 
-    if (rc != SQLITE_DONE) {
-        LOG_ERROR("Database", "Failed to update session key: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
-    }
+    g_backend->close();
+    g_open = false;
+}
 
-    return OK;
+result_t database_get_account(const char *username, account_t *account) {
+    return g_backend->get_account(username, account);
 }
 
 result_t database_get_characters(int account_id, character_list_t *list) {
-    character_list_init(list);
+    list->count = 0;
+    if (char_cache_get_account(account_id, list)) return OK;
 
-    const char *sql =
-        "SELECT id, account_id, name, race, class, gender, skin, face, "
-        "hair_style, hair_color, facial_hair, level, map, x, y, z, orientation "
-        "FROM characters WHERE account_id = ?";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
+    uint32_t generation = char_cache_generation();
+    result_t result = g_backend->get_characters(account_id, list);
+    if (result == OK) {
+        result = char_cache_load_account(account_id, generation, list);
     }
-
-    sqlite3_bind_int(stmt, 1, account_id);
-
-    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
-        character_t character;
-        character_init(&character);
-
-        character.id = sqlite3_column_int(stmt, 0);
-        character.account_id = sqlite3_column_int(stmt, 1);
-        safe_strncpy(character.name, (const char*)sqlite3_column_text(stmt, 2), sizeof(character.name));
-        character.race = (uint8_t)sqlite3_column_int(stmt, 3);
-        character.char_class = (uint8_t)sqlite3_column_int(stmt, 4);
-        character.gender = (uint8_t)sqlite3_column_int(stmt, 5);
-        character.skin = (uint8_t)sqlite3_column_int(stmt, 6);
-        character.face = (uint8_t)sqlite3_column_int(stmt, 7);
-        character.hair_style = (uint8_t)sqlite3_column_int(stmt, 8);
-        character.hair_color = (uint8_t)sqlite3_column_int(stmt, 9);
-        character.facial_hair = (uint8_t)sqlite3_column_int(stmt, 10);
-        character.level = (uint8_t)sqlite3_column_int(stmt, 11);
-        character.map = sqlite3_column_int(stmt, 12);
-        character.x = (float)sqlite3_column_double(stmt, 13);
-        character.y = (float)sqlite3_column_double(stmt, 14);
-        character.z = (float)sqlite3_column_double(stmt, 15);
-        character.orientation = (float)sqlite3_column_double(stmt, 16);
-
-        character_list_add(list, &character);
-    }
-
-    sqlite3_finalize(stmt);
-    return OK;
+    return result;
 }
 
 result_t database_get_character(int character_id, character_t *character) {
-    character_init(character);
-
-    const char *sql =
-        "SELECT id, account_id, name, race, class, gender, skin, face, "
-        "hair_style, hair_color, facial_hair, level, map, x, y, z, orientation "
-        "FROM characters WHERE id = ?";
+    if (char_cache_get(character_id, character)) return OK;
 
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
+    uint32_t generation = char_cache_generation();
+    result_t result = g_backend->get_character(character_id, character);
+    if (result == OK) {
+        char_cache_load(character, generation);
     }
+    return result;
+}
 
-    sqlite3_bind_int(stmt, 1, character_id);
-
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        character->id = sqlite3_column_int(stmt, 0);
-        character->account_id = sqlite3_column_int(stmt, 1);
-        safe_strncpy(character->name, (const char*)sqlite3_column_text(stmt, 2), sizeof(character->name));
-        character->race = (uint8_t)sqlite3_column_int(stmt, 3);
-        character->char_class = (uint8_t)sqlite3_column_int(stmt, 4);
-        character->gender = (uint8_t)sqlite3_column_int(stmt, 5);
-        character->skin = (uint8_t)sqlite3_column_int(stmt, 6);
-        character->face = (uint8_t)sqlite3_column_int(stmt, 7);
-        character->hair_style = (uint8_t)sqlite3_column_int(stmt, 8);
-        character->hair_color = (uint8_t)sqlite3_column_int(stmt, 9);
-        character->facial_hair = (uint8_t)sqlite3_column_int(stmt, 10);
-        character->level = (uint8_t)sqlite3_column_int(stmt, 11);
-        character->map = sqlite3_column_int(stmt, 12);
-        character->x = (float)sqlite3_column_double(stmt, 13);
-        character->y = (float)sqlite3_column_double(stmt, 14);
-        character->z = (float)sqlite3_column_double(stmt, 15);
-        character->orientation = (float)sqlite3_column_double(stmt, 16);
-
-        sqlite3_finalize(stmt);
-        return OK;
-    }
+result_t database_character_name_exists(const char *name, bool *exists) {
+    *exists = name_index_exists(name);
+    return OK;
+}
 
-    sqlite3_finalize(stmt);
-    return ERR_NOT_FOUND;
+result_t database_get_character_name(int character_id, character_name_t *name) {
+    return name_index_get(character_id, name) ? OK : ERR_NOT_FOUND;
 }
 
-result_t database_character_name_exists(const char *name, bool *exists) {
-    const char *sql = "SELECT COUNT(*) FROM characters WHERE name = ? COLLATE NOCASE";
+result_t database_write_begin(void) {
+    return g_backend->write_begin();
+}
 
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
+result_t database_write_apply(db_write_t *write) {
+    switch (write->type) {
+        case DB_WRITE_BARRIER:
+            return OK;
+        case DB_WRITE_CREATE_ACCOUNT:
+            return g_backend->create_account(&write->account);
+        case DB_WRITE_SESSION_KEY:
+            return g_backend->update_session_key(write->session_key.account_id, write->session_key.key);
+        case DB_WRITE_CREATE_CHARACTER:
+            return g_backend->create_character(&write->character);
+        case DB_WRITE_POSITION:
+            return g_backend->update_character_position(write->position.character_id, write->position.map,
+                                                        write->position.x, write->position.y,
+                                                        write->position.z, write->position.orientation);
+        case DB_WRITE_DELETE_CHARACTER:
+            return g_backend->delete_character(write->character_id);
     }
+    return ERR_INVALID_PARAM;
+}
 
-    sqlite3_bind_text(stmt, 1, name, -1, SQLITE_STATIC);
+result_t database_write_commit(void) {
+    return g_backend->write_commit();
+}
 
-    rc = sqlite3_step(stmt);
-    if (rc == SQLITE_ROW) {
-        *exists = sqlite3_column_int(stmt, 0) > 0;
-    } else {
-        *exists = false;
+result_t database_create_account(const char *username, const uint8_t salt[SRP6_SALT_SIZE],
+                                         const uint8_t verifier[SRP6_VERIFIER_SIZE], account_t *account) {
+    db_write_t write = { .type = DB_WRITE_CREATE_ACCOUNT };
+    account_init(&write.account);
+    safe_strncpy(write.account.username, username, sizeof(write.account.username));
+    memcpy(write.account.salt, salt, SRP6_SALT_SIZE);
+    memcpy(write.account.verifier, verifier, SRP6_VERIFIER_SIZE);
+
+    result_t result = db_writer_execute(&write);
+    if (result == OK) {
+        *account = write.account;
     }
+    return result;
+}
 
-    sqlite3_finalize(stmt);
-    return OK;
+result_t database_update_session_key(int account_id, const uint8_t session_key[SRP6_SESSION_KEY_SIZE]) {
+    db_write_t write = { .type = DB_WRITE_SESSION_KEY };
+    write.session_key.account_id = account_id;
+    memcpy(write.session_key.key, session_key, SRP6_SESSION_KEY_SIZE);
+    return db_writer_execute(&write);
 }
 
 result_t database_create_character(character_t *character) {
-    const char *sql =
-        "INSERT INTO characters (account_id, name, race, class, gender, skin, face, "
-        "hair_style, hair_color, facial_hair, level, map, x, y, z, orientation) "
-        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
-    }
-
-    sqlite3_bind_int(stmt, 1, character->account_id);
-    sqlite3_bind_text(stmt, 2, character->name, -1, SQLITE_STATIC);
-    sqlite3_bind_int(stmt, 3, character->race);
-    sqlite3_bind_int(stmt, 4, character->char_class);
-    sqlite3_bind_int(stmt, 5, character->gender);
-    sqlite3_bind_int(stmt, 6, character->skin);
-    sqlite3_bind_int(stmt, 7, character->face);
-    sqlite3_bind_int(stmt, 8, character->hair_style);
-    sqlite3_bind_int(stmt, 9, character->hair_color);
-    sqlite3_bind_int(stmt, 10, character->facial_hair);
-    sqlite3_bind_int(stmt, 11, character->level);
-    sqlite3_bind_int(stmt, 12, character->map);
-    sqlite3_bind_double(stmt, 13, character->x);
-    sqlite3_bind_double(stmt, 14, character->y);
-    sqlite3_bind_double(stmt, 15, character->z);
-    sqlite3_bind_double(stmt, 16, character->orientation);
-
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-
-    if (rc != SQLITE_DONE) {
-        LOG_ERROR("Database", "Failed to create character: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
+    db_write_t write = { .type = DB_WRITE_CREATE_CHARACTER };
+    write.character = *character;
+
+    result_t result = db_writer_execute(&write);
+    if (result == OK) {
+        character->id = write.character.id;
+        char_cache_put(character);
+
+        character_name_t name = { .id = character->id, .race = character->race,
+                                  .char_class = character->char_class, .gender = character->gender };
+        safe_strncpy(name.name, character->name, sizeof(name.name));
+        name_index_add(&name, 1);
     }
+    return result;
+}
 
-    character->id = (int)sqlite3_last_insert_rowid(g_database->db);
-    return OK;
+/* Position writes update the cache first, so it never lags storage */
+static void position_write(db_write_t *write, int character_id, int map,
+                           float x, float y, float z, float orientation) {
+    char_cache_update_position(character_id, map, x, y, z, orientation);
+
+    write->type = DB_WRITE_POSITION;
+    write->position.character_id = character_id;
+    write->position.map = map;
+    write->position.x = x;
+    write->position.y = y;
+    write->position.z = z;
+    write->position.orientation = orientation;
 }
 
 result_t database_update_character_position(int character_id, int map, float x, float y, float z, float orientation) {
-    const char *sql = "UPDATE characters SET map = ?, x = ?, y = ?, z = ?, orientation = ? WHERE id = ?";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
-    }
-
-    sqlite3_bind_int(stmt, 1, map);
-    sqlite3_bind_double(stmt, 2, x);
-    sqlite3_bind_double(stmt, 3, y);
-    sqlite3_bind_double(stmt, 4, z);
-    sqlite3_bind_double(stmt, 5, orientation);
-    sqlite3_bind_int(stmt, 6, character_id);
-
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-
-    if (rc != SQLITE_DONE) {
-        LOG_ERROR("Database", "Failed to update position: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
-    }
+    db_write_t write;
+    position_write(&write, character_id, map, x, y, z, orientation);
+    return db_writer_execute(&write);
+}
 
-    return OK;
+result_t database_save_character_position(int character_id, int map, float x, float y, float z, float orientation) {
+    db_write_t write;
+    position_write(&write, character_id, map, x, y, z, orientation);
+    return db_writer_submit(&write, NULL, NULL);
 }
 
 result_t database_delete_character(int character_id) {
-    const char *sql = "DELETE FROM characters WHERE id = ?";
-
-    sqlite3_stmt *stmt;
-    int rc = sqlite3_prepare_v2(g_database->db, sql, -1, &stmt, NULL);
-    if (rc != SQLITE_OK) {
-        LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
+    db_write_t write = { .type = DB_WRITE_DELETE_CHARACTER };
+    write.character_id = character_id;
+    result_t result = db_writer_execute(&write);
+    if (result == OK) {
+        char_cache_remove(character_id);
+        name_index_remove(character_id);
     }
-
-    sqlite3_bind_int(stmt, 1, character_id);
-
-    rc = sqlite3_step(stmt);
-    sqlite3_finalize(stmt);
-
-    if (rc != SQLITE_DONE) {
-        LOG_ERROR("Database", "Failed to delete character: %s", sqlite3_errmsg(g_database->db));
-        return ERR_DATABASE;
-    }
-
-    return OK;
+    return result;
 }
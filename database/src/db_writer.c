@@ -0,0 +1,281 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * db_writer.c - Single database writer thread with group commit
+ *
+ * Any thread can queue a write on a multi-producer/single-consumer list (an
+ * intrusive queue with a stub node: producers swap themselves in as the head,
+ * only the writer thread walks from the tail). Producers push while holding
+ * g_lock so none can slip in after shutdown has drained the queue. The writer wakes
+ * every commit interval, or at once when someone waits on a write, and
+ * applies everything queued in one transaction, so a burst of writes costs
+ * one fsync instead of one each.
+ */
+
+#include "db_writer.h"
+#include "database.h"
+#include "thread.h"
+
+/* Queue: producers swap the head, the writer thread owns the tail */
+static db_write_t g_stub;
+static db_write_t *volatile g_head = &g_stub;
+static db_write_t *g_tail = &g_stub;
+
+static thread_t g_thread;
+static mutex_t g_lock;
+static cond_t g_wake;          /* Writer: something is waiting on a commit */
+static cond_t g_done;          /* Waiters: a batch has completed */
+static bool g_wake_pending = false;
+static bool g_ready = false;    /* Lock and conds exist (set and cleared by start/stop) */
+static bool g_running = false; /* Writer accepts writes, guarded by g_lock */
+static int g_waiters = 0;      /* db_writer_execute callers not yet returned, guarded by g_lock */
+static uint32_t g_interval_ms = DB_WRITER_COMMIT_MS;
+static db_writer_stats_t g_stats;
+
+static void queue_push(db_write_t *write) {
+    write->next = NULL;
+    db_write_t *prev = (db_write_t*)atomic_exchange_ptr((void *volatile*)&g_head, write);
+    atomic_store_ptr((void *volatile*)&prev->next, write);
+}
+
+/* Take the oldest write (writer thread only). Returns NULL when empty, or
+ * when a producer is between its two steps; that write comes next time. */
+static db_write_t *queue_pop(void) {
+    db_write_t *tail = g_tail;
+    db_write_t *next = (db_write_t*)atomic_load_ptr((void *volatile*)&tail->next);
+
+    if (tail == &g_stub) {
+        if (!next) return NULL;
+        g_tail = next;
+        tail = next;
+        next = (db_write_t*)atomic_load_ptr((void *volatile*)&next->next);
+    }
+    if (next) {
+        g_tail = next;
+        return tail;
+    }
+
+    /* tail is the last write: put the stub behind it so it can be taken */
+    if (tail != atomic_load_ptr((void *volatile*)&g_head)) return NULL;
+    queue_push(&g_stub);
+    next = (db_write_t*)atomic_load_ptr((void *volatile*)&tail->next);
+    if (next) {
+        g_tail = next;
+        return tail;
+    }
+    return NULL;
+}
+
+/* Apply up to DB_WRITER_MAX_BATCH queued writes in one transaction and
+ * complete them. Returns the number of writes taken. */
+static int writer_commit_batch(bool locked) {
+    db_write_t *first = queue_pop();
+    if (!first) return 0;
+
+    result_t begin = database_write_begin();
+
+    /* Taken writes are chained through next in queue order */
+    db_write_t *last = NULL;
+    int count = 0;
+    for (db_write_t *write = first; write; write = count < DB_WRITER_MAX_BATCH ? queue_pop() : NULL) {
+        write->result = begin == OK ? database_write_apply(write) : begin;
+        if (last) last->next = write;
+        last = write;
+        count++;
+    }
+    last->next = NULL;
+
+    if (begin == OK && database_write_commit() != OK) {
+        for (db_write_t *write = first; write; write = write->next) {
+            write->result = ERR_DATABASE;
+        }
+    }
+
+    /* Run callbacks and free submitted copies; collect the waiters */
+    db_write_t *waiters = NULL;
+    int failed = 0;
+    for (db_write_t *write = first, *next; write; write = next) {
+        next = write->next;
+        if (write->result != OK) failed++;
+        if (write->heap) {
+            if (write->callback) {
+                write->callback(write, write->callback_ctx);
+            }
+            free(write);
+        } else {
+            write->next = waiters;
+            waiters = write;
+        }
+    }
+
+    /* A waiter's write lives on its stack: don't touch it once it can run */
+    if (!locked) mutex_lock(&g_lock);
+    for (db_write_t *write = waiters, *next; write; write = next) {
+        next = write->next;
+        write->done = true;
+    }
+    g_stats.writes += (uint64_t)count;
+    g_stats.batches++;
+    g_stats.failed += (uint64_t)failed;
+    if ((uint32_t)count > g_stats.max_batch) {
+        g_stats.max_batch = (uint32_t)count;
+    }
+    cond_broadcast(&g_done);
+    if (!locked) mutex_unlock(&g_lock);
+
+    return count;
+}
+
+static void writer_thread(void *arg) {
+    (void)arg;
+
+    for (;;) {
+        mutex_lock(&g_lock);
+        if (g_running && !g_wake_pending) {
+            cond_timed_wait(&g_wake, &g_lock, g_interval_ms);
+        }
+        g_wake_pending = false;
+        bool running = g_running;
+        mutex_unlock(&g_lock);
+
+        while (writer_commit_batch(false) == DB_WRITER_MAX_BATCH) {
+            /* Keep going while batches come out full */
+        }
+
+        if (!running) break;
+    }
+}
+
+result_t db_writer_start(uint32_t commit_interval_ms) {
+    if (g_ready) return ERR_ALREADY_EXISTS;
+
+    mutex_init(&g_lock);
+    cond_init(&g_wake);
+    cond_init(&g_done);
+    memset(&g_stats, 0, sizeof(g_stats));
+    g_interval_ms = commit_interval_ms > 0 ? commit_interval_ms : DB_WRITER_COMMIT_MS;
+    g_running = true;
+    g_ready = true;
+
+    if (thread_create(&g_thread, writer_thread, NULL) != OK) {
+        g_ready = false;
+        g_running = false;
+        cond_destroy(&g_done);
+        cond_destroy(&g_wake);
+        mutex_destroy(&g_lock);
+        return ERR_MEMORY;
+    }
+
+    LOG_INFO("Database", "Writer thread started (%u ms commit interval)", g_interval_ms);
+    return OK;
+}
+
+void db_writer_stop(void) {
+    if (!g_ready) return;
+
+    mutex_lock(&g_lock);
+    g_running = false;
+    cond_signal(&g_wake);
+    mutex_unlock(&g_lock);
+    thread_join(g_thread);
+
+    mutex_lock(&g_lock);
+    /* Pushes stop with g_running, but the writer may have exited between batches */
+    while (writer_commit_batch(true) > 0) {
+    }
+
+    /* Completed waiters still need the lock to return */
+    while (g_waiters > 0) {
+        cond_wait(&g_done, &g_lock);
+    }
+    g_ready = false;
+    mutex_unlock(&g_lock);
+
+    LOG_INFO("Database", "Writer: %llu writes in %llu transactions (largest %u), %llu failed",
+             (unsigned long long)g_stats.writes, (unsigned long long)g_stats.batches,
+             g_stats.max_batch, (unsigned long long)g_stats.failed);
+
+    cond_destroy(&g_done);
+    cond_destroy(&g_wake);
+    mutex_destroy(&g_lock);
+}
+
+/* Lock g_lock and return true if the writer thread takes writes; on false
+ * the lock is not held and the caller applies the write itself */
+static bool writer_lock_running(void) {
+    if (!g_ready) return false;
+    mutex_lock(&g_lock);
+    if (g_running) return true;
+    mutex_unlock(&g_lock);
+    return false;
+}
+
+result_t db_writer_submit(const db_write_t *write, db_write_callback_t callback, void *ctx) {
+    db_write_t *copy = ALLOC(db_write_t);
+    if (!copy) return ERR_MEMORY;
+
+    *copy = *write;
+    copy->callback = callback;
+    copy->callback_ctx = ctx;
+    copy->heap = true;
+
+    if (writer_lock_running()) {
+        queue_push(copy);
+        mutex_unlock(&g_lock);
+        return OK;
+    }
+
+    /* No writer thread: apply it now */
+    result_t result = database_write_begin();
+    if (result == OK) {
+        copy->result = database_write_apply(copy);
+        result = database_write_commit();
+    }
+    if (result != OK) copy->result = result;
+    if (callback) callback(copy, ctx);
+    result = copy->result;
+    free(copy);
+    return result;
+}
+
+result_t db_writer_execute(db_write_t *write) {
+    write->callback = NULL;
+    write->callback_ctx = NULL;
+    write->heap = false;
+    write->done = false;
+
+    if (!writer_lock_running()) {
+        result_t result = database_write_begin();
+        if (result != OK) return result;
+        write->result = database_write_apply(write);
+        result = database_write_commit();
+        return result != OK ? result : write->result;
+    }
+
+    queue_push(write);
+    g_waiters++;
+    g_wake_pending = true;
+    cond_signal(&g_wake);
+    while (!write->done) {
+        cond_wait(&g_done, &g_lock);
+    }
+    if (--g_waiters == 0 && !g_running) {
+        cond_broadcast(&g_done);  /* db_writer_stop is waiting for us */
+    }
+    mutex_unlock(&g_lock);
+
+    return write->result;
+}
+
+void db_writer_flush(void) {
+    db_write_t barrier = { .type = DB_WRITE_BARRIER };
+    db_writer_execute(&barrier);
+}
+
+void db_writer_get_stats(db_writer_stats_t *stats) {
+    bool ready = g_ready;
+    if (ready) mutex_lock(&g_lock);
+    *stats = g_stats;
+    if (ready) mutex_unlock(&g_lock);
+}
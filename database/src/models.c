@@ -24,10 +24,20 @@ void character_list_init(character_list_t *list) {
     list->items = NULL;
     list->count = 0;
     list->capacity = 0;
+    list->arena = NULL;
+}
+
+void character_list_init_arena(character_list_t *list, arena_t *arena) {
+    character_list_init(list);
+    list->arena = arena;
 }
 
 void character_list_free(character_list_t *list) {
-    FREE(list->items);
+    if (list->arena) {
+        list->items = NULL;
+    } else {
+        FREE(list->items);
+    }
     list->count = 0;
     list->capacity = 0;
 }
@@ -35,7 +45,16 @@ void character_list_free(character_list_t *list) {
 result_t character_list_add(character_list_t *list, const character_t *character) {
     if (list->count >= list->capacity) {
         int new_capacity = list->capacity == 0 ? 4 : list->capacity * 2;
-        character_t *new_items = (character_t*)realloc(list->items, new_capacity * sizeof(character_t));
+        character_t *new_items;
+        if (list->arena) {
+            /* The old array stays in the arena until its next reset */
+            new_items = (character_t*)arena_alloc(list->arena, new_capacity * sizeof(character_t));
+            if (new_items && list->count > 0) {
+                memcpy(new_items, list->items, list->count * sizeof(character_t));
+            }
+        } else {
+            new_items = (character_t*)realloc(list->items, new_capacity * sizeof(character_t));
+        }
         if (!new_items) return ERR_MEMORY;
         list->items = new_items;
         list->capacity = new_capacity;
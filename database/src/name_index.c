@@ -0,0 +1,245 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * name_index.c - Resident index of every character name
+ *
+ * Loaded in full at startup and kept in step with creates and deletes, so
+ * name checks and name queries never reach storage. Each entry is chained
+ * into two hash tables: by case-folded name, for uniqueness, and by GUID.
+ * Folding only covers ASCII, matching SQLite's NOCASE collation on the
+ * column the index mirrors.
+ */
+
+#include "name_index.h"
+#include "thread.h"
+
+typedef struct name_entry {
+    character_name_t name;
+    uint32_t name_hash;
+    struct name_entry *next_name;  /* Name bucket chain */
+    struct name_entry *next_id;    /* GUID bucket chain */
+} name_entry_t;
+
+static mutex_t g_lock;
+static bool g_initialized = false;
+
+static name_entry_t **g_by_name = NULL;
+static name_entry_t **g_by_id = NULL;
+static uint32_t g_mask = 0;  /* Both tables have the same size */
+
+static name_index_stats_t g_stats;
+
+static uint8_t fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c - 'A' + 'a') : (uint8_t)c;
+}
+
+/* FNV-1a over the folded name */
+static uint32_t hash_name(const char *name) {
+    uint32_t h = 2166136261u;
+    for (; *name; name++) {
+        h = (h ^ fold(*name)) * 16777619u;
+    }
+    return h;
+}
+
+static uint32_t hash_id(int id) {
+    uint32_t h = (uint32_t)id * 2654435761u;
+    return h ^ (h >> 16);
+}
+
+static bool names_equal(const char *a, const char *b) {
+    while (*a && fold(*a) == fold(*b)) {
+        a++;
+        b++;
+    }
+    return fold(*a) == fold(*b);
+}
+
+static name_entry_t *find_name(const char *name, uint32_t hash) {
+    name_entry_t *entry = g_by_name[hash & g_mask];
+    while (entry && (entry->name_hash != hash || !names_equal(entry->name.name, name))) {
+        entry = entry->next_name;
+    }
+    return entry;
+}
+
+static name_entry_t *find_id(int character_id) {
+    name_entry_t *entry = g_by_id[hash_id(character_id) & g_mask];
+    while (entry && entry->name.id != character_id) {
+        entry = entry->next_id;
+    }
+    return entry;
+}
+
+/* Rehash both tables into size buckets */
+static result_t resize(uint32_t size) {
+    name_entry_t **by_name = ALLOC_ARRAY(name_entry_t*, size);
+    name_entry_t **by_id = ALLOC_ARRAY(name_entry_t*, size);
+    if (!by_name || !by_id) {
+        free(by_name);
+        free(by_id);
+        return ERR_MEMORY;
+    }
+
+    uint32_t mask = size - 1;
+    for (uint32_t i = 0; g_by_name && i <= g_mask; i++) {
+        for (name_entry_t *entry = g_by_name[i], *next; entry; entry = next) {
+            next = entry->next_name;
+            uint32_t b = entry->name_hash & mask;
+            entry->next_name = by_name[b];
+            by_name[b] = entry;
+
+            b = hash_id(entry->name.id) & mask;
+            entry->next_id = by_id[b];
+            by_id[b] = entry;
+        }
+    }
+    free(g_by_name);
+    free(g_by_id);
+    g_by_name = by_name;
+    g_by_id = by_id;
+    g_mask = mask;
+    return OK;
+}
+
+result_t name_index_init(uint32_t expected) {
+    if (g_initialized) return ERR_ALREADY_EXISTS;
+
+    uint32_t size = NAME_INDEX_MIN_BUCKETS;
+    while (size < expected && size < (1u << 30)) {
+        size *= 2;
+    }
+    result_t result = resize(size);
+    if (result != OK) return result;
+
+    memset(&g_stats, 0, sizeof(g_stats));
+    mutex_init(&g_lock);
+    g_initialized = true;
+    return OK;
+}
+
+void name_index_shutdown(void) {
+    if (!g_initialized) return;
+
+    g_initialized = false;
+    for (uint32_t i = 0; i <= g_mask; i++) {
+        for (name_entry_t *entry = g_by_name[i], *next; entry; entry = next) {
+            next = entry->next_name;
+            free(entry);
+        }
+    }
+    FREE(g_by_name);
+    FREE(g_by_id);
+    g_mask = 0;
+    mutex_destroy(&g_lock);
+}
+
+int name_index_add(const character_name_t *names, int count) {
+    if (!g_initialized || count <= 0) return 0;
+
+    /* Allocate and hash outside the lock; only linking is serialized */
+    name_entry_t **entries = ALLOC_ARRAY(name_entry_t*, count);
+    if (!entries) return 0;
+    int allocated = 0;
+    while (allocated < count) {
+        name_entry_t *entry = (name_entry_t*)malloc(sizeof(name_entry_t));
+        if (!entry) break;
+        entry->name = names[allocated];
+        entry->name_hash = hash_name(entry->name.name);
+        entries[allocated++] = entry;
+    }
+
+    int added = 0;
+    mutex_lock(&g_lock);
+    for (int i = 0; i < allocated; i++) {
+        name_entry_t *entry = entries[i];
+        if (find_name(entry->name.name, entry->name_hash) || find_id(entry->name.id)) continue;
+
+        uint32_t b = entry->name_hash & g_mask;
+        entry->next_name = g_by_name[b];
+        g_by_name[b] = entry;
+        b = hash_id(entry->name.id) & g_mask;
+        entry->next_id = g_by_id[b];
+        g_by_id[b] = entry;
+
+        entries[i] = NULL;
+        g_stats.names++;
+        added++;
+    }
+
+    /* Keep the load factor at or below one */
+    if (g_stats.names > g_mask) {
+        resize((g_mask + 1) * 2);
+    }
+    mutex_unlock(&g_lock);
+
+    /* Entries left over were duplicates */
+    for (int i = 0; i < allocated; i++) {
+        free(entries[i]);
+    }
+    free(entries);
+    return added;
+}
+
+void name_index_remove(int character_id) {
+    if (!g_initialized) return;
+
+    mutex_lock(&g_lock);
+    name_entry_t **link = &g_by_id[hash_id(character_id) & g_mask];
+    while (*link && (*link)->name.id != character_id) {
+        link = &(*link)->next_id;
+    }
+
+    name_entry_t *entry = *link;
+    if (entry) {
+        *link = entry->next_id;
+
+        link = &g_by_name[entry->name_hash & g_mask];
+        while (*link != entry) {
+            link = &(*link)->next_name;
+        }
+        *link = entry->next_name;
+
+        free(entry);
+        g_stats.names--;
+    }
+    mutex_unlock(&g_lock);
+}
+
+bool name_index_exists(const char *name) {
+    if (!g_initialized) return false;
+
+    uint32_t hash = hash_name(name);
+    mutex_lock(&g_lock);
+    bool exists = find_name(name, hash) != NULL;
+    g_stats.name_checks++;
+    mutex_unlock(&g_lock);
+    return exists;
+}
+
+bool name_index_get(int character_id, character_name_t *name) {
+    if (!g_initialized) return false;
+
+    mutex_lock(&g_lock);
+    name_entry_t *entry = find_id(character_id);
+    if (entry) {
+        *name = entry->name;
+    } else {
+        g_stats.misses++;
+    }
+    g_stats.lookups++;
+    mutex_unlock(&g_lock);
+    return entry != NULL;
+}
+
+void name_index_get_stats(name_index_stats_t *stats) {
+    if (!g_initialized) {
+        memset(stats, 0, sizeof(*stats));
+        return;
+    }
+
+    mutex_lock(&g_lock);
+    *stats = g_stats;
+    mutex_unlock(&g_lock);
+}
@@ -0,0 +1,450 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * storage_memory.c - In-memory storage backend
+ *
+ * Accounts and characters live in chained hash tables and are gone at
+ * shutdown: an ephemeral realm, and a backend for load tests and benches
+ * that should not measure the disk. Accounts are found by ID or by
+ * username and characters by ID or by name, names ignoring ASCII case
+ * like the SQLite schema; each account links its characters in ascending
+ * ID order. One mutex covers everything.
+ */
+
+#include "storage.h"
+#include "thread.h"
+
+/* Minimum bucket count of each hash table (power of two) */
+#define MEMORY_MIN_BUCKETS 1024
+
+typedef struct mem_character {
+    character_t character;
+    uint32_t name_hash;
+    struct mem_character *next_id;       /* ID bucket chain */
+    struct mem_character *next_name;     /* Name bucket chain */
+    struct mem_character *next_account;  /* Account's characters, ascending ID */
+} mem_character_t;
+
+typedef struct mem_account {
+    account_t account;
+    uint32_t name_hash;
+    struct mem_account *next_id;
+    struct mem_account *next_name;
+    mem_character_t *characters;
+} mem_account_t;
+
+static mutex_t g_lock;
+static bool g_open = false;
+
+/* The ID and name tables of each kind share a size */
+static mem_account_t **g_accounts_by_id = NULL;
+static mem_account_t **g_accounts_by_name = NULL;
+static uint32_t g_account_mask = 0;
+static uint32_t g_account_count = 0;
+static int g_next_account_id = 1;
+
+static mem_character_t **g_characters_by_id = NULL;
+static mem_character_t **g_characters_by_name = NULL;
+static uint32_t g_character_mask = 0;
+static uint32_t g_character_count = 0;
+static int g_next_character_id = 1;
+
+static uint8_t fold(char c) {
+    return (c >= 'A' && c <= 'Z') ? (uint8_t)(c - 'A' + 'a') : (uint8_t)c;
+}
+
+/* FNV-1a over the folded name */
+static uint32_t hash_name(const char *name) {
+    uint32_t h = 2166136261u;
+    for (; *name; name++) {
+        h = (h ^ fold(*name)) * 16777619u;
+    }
+    return h;
+}
+
+static uint32_t hash_id(int id) {
+    uint32_t h = (uint32_t)id * 2654435761u;
+    return h ^ (h >> 16);
+}
+
+static bool names_equal(const char *a, const char *b) {
+    while (*a && fold(*a) == fold(*b)) {
+        a++;
+        b++;
+    }
+    return fold(*a) == fold(*b);
+}
+
+static mem_account_t *find_account_id(int account_id) {
+    mem_account_t *entry = g_accounts_by_id[hash_id(account_id) & g_account_mask];
+    while (entry && entry->account.id != account_id) {
+        entry = entry->next_id;
+    }
+    return entry;
+}
+
+static mem_account_t *find_account_name(const char *username, uint32_t hash) {
+    mem_account_t *entry = g_accounts_by_name[hash & g_account_mask];
+    while (entry && (entry->name_hash != hash || !names_equal(entry->account.username, username))) {
+        entry = entry->next_name;
+    }
+    return entry;
+}
+
+static mem_character_t *find_character_id(int character_id) {
+    mem_character_t *entry = g_characters_by_id[hash_id(character_id) & g_character_mask];
+    while (entry && entry->character.id != character_id) {
+        entry = entry->next_id;
+    }
+    return entry;
+}
+
+static mem_character_t *find_character_name(const char *name, uint32_t hash) {
+    mem_character_t *entry = g_characters_by_name[hash & g_character_mask];
+    while (entry && (entry->name_hash != hash || !names_equal(entry->character.name, name))) {
+        entry = entry->next_name;
+    }
+    return entry;
+}
+
+/* Double the account tables once they hold more entries than buckets */
+static void grow_accounts(void) {
+    if (g_account_count <= g_account_mask) return;
+
+    uint32_t mask = g_account_mask * 2 + 1;
+    mem_account_t **by_id = ALLOC_ARRAY(mem_account_t*, mask + 1);
+    mem_account_t **by_name = ALLOC_ARRAY(mem_account_t*, mask + 1);
+    if (!by_id || !by_name) {
+        free(by_id);
+        free(by_name);
+        return;
+    }
+
+    for (uint32_t i = 0; i <= g_account_mask; i++) {
+        for (mem_account_t *entry = g_accounts_by_id[i], *next; entry; entry = next) {
+            next = entry->next_id;
+            uint32_t b = hash_id(entry->account.id) & mask;
+            entry->next_id = by_id[b];
+            by_id[b] = entry;
+
+            b = entry->name_hash & mask;
+            entry->next_name = by_name[b];
+            by_name[b] = entry;
+        }
+    }
+    free(g_accounts_by_id);
+    free(g_accounts_by_name);
+    g_accounts_by_id = by_id;
+    g_accounts_by_name = by_name;
+    g_account_mask = mask;
+}
+
+static void grow_characters(void) {
+    if (g_character_count <= g_character_mask) return;
+
+    uint32_t mask = g_character_mask * 2 + 1;
+    mem_character_t **by_id = ALLOC_ARRAY(mem_character_t*, mask + 1);
+    mem_character_t **by_name = ALLOC_ARRAY(mem_character_t*, mask + 1);
+    if (!by_id || !by_name) {
+        free(by_id);
+        free(by_name);
+        return;
+    }
+
+    for (uint32_t i = 0; i <= g_character_mask; i++) {
+        for (mem_character_t *entry = g_characters_by_id[i], *next; entry; entry = next) {
+            next = entry->next_id;
+            uint32_t b = hash_id(entry->character.id) & mask;
+            entry->next_id = by_id[b];
+            by_id[b] = entry;
+
+            b = entry->name_hash & mask;
+            entry->next_name = by_name[b];
+            by_name[b] = entry;
+        }
+    }
+    free(g_characters_by_id);
+    free(g_characters_by_name);
+    g_characters_by_id = by_id;
+    g_characters_by_name = by_name;
+    g_character_mask = mask;
+}
+
+static void free_tables(void) {
+    for (uint32_t i = 0; g_characters_by_id && i <= g_character_mask; i++) {
+        for (mem_character_t *entry = g_characters_by_id[i], *next; entry; entry = next) {
+            next = entry->next_id;
+            free(entry);
+        }
+    }
+    for (uint32_t i = 0; g_accounts_by_id && i <= g_account_mask; i++) {
+        for (mem_account_t *entry = g_accounts_by_id[i], *next; entry; entry = next) {
+            next = entry->next_id;
+            free(entry);
+        }
+    }
+    FREE(g_characters_by_id);
+    FREE(g_characters_by_name);
+    FREE(g_accounts_by_id);
+    FREE(g_accounts_by_name);
+}
+
+static result_t memory_open(const char *path) {
+    (void)path;
+    if (g_open) return ERR_ALREADY_EXISTS;
+
+    g_accounts_by_id = ALLOC_ARRAY(mem_account_t*, MEMORY_MIN_BUCKETS);
+    g_accounts_by_name = ALLOC_ARRAY(mem_account_t*, MEMORY_MIN_BUCKETS);
+    g_characters_by_id = ALLOC_ARRAY(mem_character_t*, MEMORY_MIN_BUCKETS);
+    g_characters_by_name = ALLOC_ARRAY(mem_character_t*, MEMORY_MIN_BUCKETS);
+    if (!g_accounts_by_id || !g_accounts_by_name || !g_characters_by_id || !g_characters_by_name) {
+        free_tables();
+        return ERR_MEMORY;
+    }
+    g_account_mask = MEMORY_MIN_BUCKETS - 1;
+    g_character_mask = MEMORY_MIN_BUCKETS - 1;
+    g_account_count = 0;
+    g_character_count = 0;
+    g_next_account_id = 1;
+    g_next_character_id = 1;
+
+    mutex_init(&g_lock);
+    g_open = true;
+
+    LOG_INFO("Database", "Opened in-memory storage (nothing is kept after shutdown)");
+    return OK;
+}
+
+static void memory_close(void) {
+    if (!g_open) return;
+
+    LOG_INFO("Database", "Discarding in-memory storage: %u accounts, %u characters",
+             g_account_count, g_character_count);
+    g_open = false;
+    free_tables();
+    mutex_destroy(&g_lock);
+}
+
+static void memory_thread_release(void) {
+}
+
+static result_t memory_get_account(const char *username, account_t *account) {
+    uint32_t hash = hash_name(username);
+
+    mutex_lock(&g_lock);
+    mem_account_t *entry = find_account_name(username, hash);
+    if (entry) {
+        *account = entry->account;
+    } else {
+        account_init(account);
+    }
+    mutex_unlock(&g_lock);
+    return entry ? OK : ERR_NOT_FOUND;
+}
+
+static result_t memory_get_characters(int account_id, character_list_t *list) {
+    result_t result = OK;
+
+    mutex_lock(&g_lock);
+    mem_account_t *account = find_account_id(account_id);
+    for (mem_character_t *entry = account ? account->characters : NULL; entry && result == OK;
+         entry = entry->next_account) {
+        result = character_list_add(list, &entry->character);
+    }
+    mutex_unlock(&g_lock);
+    return result;
+}
+
+static result_t memory_get_character(int character_id, character_t *character) {
+    mutex_lock(&g_lock);
+    mem_character_t *entry = find_character_id(character_id);
+    if (entry) {
+        *character = entry->character;
+    } else {
+        character_init(character);
+    }
+    mutex_unlock(&g_lock);
+    return entry ? OK : ERR_NOT_FOUND;
+}
+
+static result_t memory_character_id_range(int *count, int *first_id, int *last_id) {
+    mutex_lock(&g_lock);
+    *count = (int)g_character_count;
+    *first_id = 0;
+    *last_id = 0;
+    for (uint32_t i = 0; i <= g_character_mask; i++) {
+        for (mem_character_t *entry = g_characters_by_id[i]; entry; entry = entry->next_id) {
+            int id = entry->character.id;
+            if (*first_id == 0 || id < *first_id) *first_id = id;
+            if (id > *last_id) *last_id = id;
+        }
+    }
+    mutex_unlock(&g_lock);
+    return OK;
+}
+
+static result_t memory_get_character_names(int first_id, int last_id, storage_name_fn fn, void *ctx) {
+    mutex_lock(&g_lock);
+    for (uint32_t i = 0; i <= g_character_mask; i++) {
+        for (mem_character_t *entry = g_characters_by_id[i]; entry; entry = entry->next_id) {
+            const character_t *c = &entry->character;
+            if (c->id < first_id || c->id > last_id) continue;
+
+            character_name_t name = { .id = c->id, .race = c->race, .char_class = c->char_class,
+                                      .gender = c->gender };
+            safe_strncpy(name.name, c->name, sizeof(name.name));
+            fn(&name, ctx);
+        }
+    }
+    mutex_unlock(&g_lock);
+    return OK;
+}
+
+/* Every write stands alone, so there is no transaction to open or close */
+static result_t memory_write_begin(void) {
+    return OK;
+}
+
+static result_t memory_write_commit(void) {
+    return OK;
+}
+
+static result_t memory_create_account(account_t *account) {
+    mem_account_t *entry = ALLOC(mem_account_t);
+    if (!entry) return ERR_MEMORY;
+    entry->name_hash = hash_name(account->username);
+
+    mutex_lock(&g_lock);
+    if (find_account_name(account->username, entry->name_hash)) {
+        mutex_unlock(&g_lock);
+        free(entry);
+        return ERR_ALREADY_EXISTS;
+    }
+
+    account->id = g_next_account_id++;
+    entry->account = *account;
+
+    uint32_t b = hash_id(account->id) & g_account_mask;
+    entry->next_id = g_accounts_by_id[b];
+    g_accounts_by_id[b] = entry;
+    b = entry->name_hash & g_account_mask;
+    entry->next_name = g_accounts_by_name[b];
+    g_accounts_by_name[b] = entry;
+
+    g_account_count++;
+    grow_accounts();
+    mutex_unlock(&g_lock);
+    return OK;
+}
+
+static result_t memory_update_session_key(int account_id, const uint8_t session_key[SRP6_SESSION_KEY_SIZE]) {
+    mutex_lock(&g_lock);
+    mem_account_t *entry = find_account_id(account_id);
+    if (entry) {
+        memcpy(entry->account.session_key, session_key, SRP6_SESSION_KEY_SIZE);
+        entry->account.has_session_key = true;
+    }
+    mutex_unlock(&g_lock);
+    return OK;
+}
+
+static result_t memory_create_character(character_t *character) {
+    mem_character_t *entry = ALLOC(mem_character_t);
+    if (!entry) return ERR_MEMORY;
+    entry->name_hash = hash_name(character->name);
+
+    mutex_lock(&g_lock);
+    mem_account_t *account = find_account_id(character->account_id);
+    if (!account || find_character_name(character->name, entry->name_hash)) {
+        mutex_unlock(&g_lock);
+        free(entry);
+        return account ? ERR_ALREADY_EXISTS : ERR_NOT_FOUND;
+    }
+
+    character->id = g_next_character_id++;
+    entry->character = *character;
+
+    uint32_t b = hash_id(character->id) & g_character_mask;
+    entry->next_id = g_characters_by_id[b];
+    g_characters_by_id[b] = entry;
+    b = entry->name_hash & g_character_mask;
+    entry->next_name = g_characters_by_name[b];
+    g_characters_by_name[b] = entry;
+
+    /* IDs only grow, so a new character goes at the end */
+    mem_character_t **link = &account->characters;
+    while (*link) {
+        link = &(*link)->next_account;
+    }
+    *link = entry;
+
+    g_character_count++;
+    grow_characters();
+    mutex_unlock(&g_lock);
+    return OK;
+}
+
+static result_t memory_update_character_position(int character_id, int map, float x, float y, float z, float orientation) {
+    mutex_lock(&g_lock);
+    mem_character_t *entry = find_character_id(character_id);
+    if (entry) {
+        entry->character.map = map;
+        entry->character.x = x;
+        entry->character.y = y;
+        entry->character.z = z;
+        entry->character.orientation = orientation;
+    }
+    mutex_unlock(&g_lock);
+    return OK;
+}
+
+static result_t memory_delete_character(int character_id) {
+    mutex_lock(&g_lock);
+    mem_character_t **link = &g_characters_by_id[hash_id(character_id) & g_character_mask];
+    while (*link && (*link)->character.id != character_id) {
+        link = &(*link)->next_id;
+    }
+
+    mem_character_t *entry = *link;
+    if (entry) {
+        *link = entry->next_id;
+
+        link = &g_characters_by_name[entry->name_hash & g_character_mask];
+        while (*link != entry) {
+            link = &(*link)->next_name;
+        }
+        *link = entry->next_name;
+
+        mem_account_t *account = find_account_id(entry->character.account_id);
+        link = &account->characters;
+        while (*link != entry) {
+            link = &(*link)->next_account;
+        }
+        *link = entry->next_account;
+
+        free(entry);
+        g_character_count--;
+    }
+    mutex_unlock(&g_lock);
+    return OK;
+}
+
+const storage_backend_t storage_memory = {
+    .name = "memory",
+    .open = memory_open,
+    .close = memory_close,
+    .thread_release = memory_thread_release,
+    .get_account = memory_get_account,
+    .get_characters = memory_get_characters,
+    .get_character = memory_get_character,
+    .character_id_range = memory_character_id_range,
+    .get_character_names = memory_get_character_names,
+    .write_begin = memory_write_begin,
+    .create_account = memory_create_account,
+    .update_session_key = memory_update_session_key,
+    .create_character = memory_create_character,
+    .update_character_position = memory_update_character_position,
+    .delete_character = memory_delete_character,
+    .write_commit = memory_write_commit,
+};
@@ -0,0 +1,690 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * storage_sqlite.c - SQLite storage backend
+ *
+ * Every query is prepared once per connection and reused: a call binds
+ * its parameters, steps, then resets and clears the statement. Writes go
+ * through the writer thread on the one read-write connection; every thread
+ * that reads gets its own read-only connection, so with WAL readers never
+ * wait on each other or on the writer.
+ */
+
+#include "storage_sqlite.h"
+
+/* Global database instance */
+database_t *g_database = NULL;
+
+/* How long a connection waits on another's lock before SQLITE_BUSY */
+#define DB_BUSY_TIMEOUT_MS 5000
+
+/* One schema change. Steps run in order, each in its own transaction;
+ * the schema_version table records every step a database has had. */
+typedef struct {
+    int version;
+    const char *description;
+    const char *sql;
+} db_migration_t;
+
+/* Append new steps at the end; never edit one that has shipped. Step 1
+ * uses IF NOT EXISTS so databases from before versioning adopt it. */
+static const db_migration_t MIGRATIONS[] = {
+    { 1, "accounts and characters",
+      "CREATE TABLE IF NOT EXISTS accounts ("
+      "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+      "    username TEXT NOT NULL UNIQUE COLLATE NOCASE,"
+      "    salt BLOB NOT NULL,"
+      "    verifier BLOB NOT NULL,"
+      "    session_key BLOB"
+      ");"
+      ""
+      "CREATE TABLE IF NOT EXISTS characters ("
+      "    id INTEGER PRIMARY KEY AUTOINCREMENT,"
+      "    account_id INTEGER NOT NULL,"
+      "    name TEXT NOT NULL UNIQUE COLLATE NOCASE,"
+      "    race INTEGER NOT NULL,"
+      "    class INTEGER NOT NULL,"
+      "    gender INTEGER NOT NULL,"
+      "    skin INTEGER DEFAULT 0,"
+      "    face INTEGER DEFAULT 0,"
+      "    hair_style INTEGER DEFAULT 0,"
+      "    hair_color INTEGER DEFAULT 0,"
+      "    facial_hair INTEGER DEFAULT 0,"
+      "    level INTEGER DEFAULT 1,"
+      "    map INTEGER DEFAULT 0,"
+      "    x REAL NOT NULL,"
+      "    y REAL NOT NULL,"
+      "    z REAL NOT NULL,"
+      "    orientation REAL DEFAULT 0,"
+      "    FOREIGN KEY (account_id) REFERENCES accounts(id)"
+      ");" },
+    { 2, "index characters by account",
+      "CREATE INDEX IF NOT EXISTS idx_characters_account_id ON characters (account_id);" },
+};
+
+#define MIGRATION_COUNT ((int)(sizeof(MIGRATIONS) / sizeof(MIGRATIONS[0])))
+
+static const char *SCHEMA_VERSION_SQL =
+    "CREATE TABLE IF NOT EXISTS schema_version ("
+    "    version INTEGER PRIMARY KEY,"
+    "    description TEXT NOT NULL,"
+    "    applied_at INTEGER NOT NULL"
+    ");";
+
+/* Default profile: WAL with fsync at checkpoints, 256 MB mapped, 64 MB cache */
+#define BALANCED_PROFILE \
+    { "balanced", DB_JOURNAL_WAL, DB_SYNC_NORMAL, 256 * 1024 * 1024, 65536, true }
+
+/* Built-in storage profiles, indexed by db_profile_id_t */
+static const db_profile_t PROFILES[DB_PROFILE_COUNT] = {
+    [DB_PROFILE_LEGACY]   = { "legacy", DB_JOURNAL_DELETE, DB_SYNC_FULL, 0, 2000, false },
+    [DB_PROFILE_DURABLE]  = { "durable", DB_JOURNAL_WAL, DB_SYNC_FULL, 256 * 1024 * 1024, 65536, true },
+    [DB_PROFILE_BALANCED] = BALANCED_PROFILE,
+};
+
+static db_profile_t g_profile = BALANCED_PROFILE;
+
+result_t database_profile_get(db_profile_id_t id, db_profile_t *profile) {
+    if ((int)id < 0 || id >= DB_PROFILE_COUNT) return ERR_INVALID_PARAM;
+    *profile = PROFILES[id];
+    return OK;
+}
+
+result_t database_profile_find(const char *name, db_profile_t *profile) {
+    for (int i = 0; i < DB_PROFILE_COUNT; i++) {
+        if (strcmp(PROFILES[i].name, name) == 0) {
+            *profile = PROFILES[i];
+            return OK;
+        }
+    }
+    return ERR_NOT_FOUND;
+}
+
+result_t database_set_profile(const db_profile_t *profile) {
+    if (profile->synchronous < DB_SYNC_OFF || profile->synchronous > DB_SYNC_FULL) return ERR_INVALID_PARAM;
+    if (profile->mmap_size < 0 || profile->cache_size_kb <= 0) return ERR_INVALID_PARAM;
+
+    g_profile = *profile;
+    return OK;
+}
+
+void database_get_profile(db_profile_t *profile) {
+    *profile = g_profile;
+}
+
+/* Apply the storage profile to a freshly opened connection. The journal
+ * mode is a property of the file, so only the writer sets it. */
+static result_t apply_profile(sqlite3 *db, const db_profile_t *profile, bool writer) {
+    char sql[128];
+
+    if (writer) {
+        /* journal_mode reports the mode it ended up in (":memory:" stays "memory") */
+        const char *journal = profile->journal_mode == DB_JOURNAL_WAL ? "wal" : "delete";
+        snprintf(sql, sizeof(sql), "PRAGMA journal_mode=%s", journal);
+
+        sqlite3_stmt *stmt;
+        if (sqlite3_prepare_v2(db, sql, -1, &stmt, NULL) != SQLITE_OK) return ERR_DATABASE;
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            const char *mode = (const char*)sqlite3_column_text(stmt, 0);
+            if (mode && strcmp(mode, journal) != 0) {
+                LOG_INFO("Database", "Journal mode is %s (wanted %s)", mode, journal);
+            }
+        }
+        sqlite3_finalize(stmt);
+    }
+
+    /* Readers and the writer wait for each other rather than fail */
+    sqlite3_busy_timeout(db, DB_BUSY_TIMEOUT_MS);
+
+    /* Negative cache_size is in KiB rather than pages */
+    snprintf(sql, sizeof(sql),
+             "PRAGMA synchronous=%d; PRAGMA mmap_size=%lld; PRAGMA cache_size=-%d; PRAGMA temp_store=%d;",
+             (int)profile->synchronous, (long long)profile->mmap_size, profile->cache_size_kb,
+             profile->temp_store_memory ? 2 : 0);
+
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        LOG_ERROR("Database", "Failed to apply profile %s: %s", profile->name, err_msg);
+        sqlite3_free(err_msg);
+        return ERR_DATABASE;
+    }
+    return OK;
+}
+
+/* SQL for the cached statements, indexed by db_statement_t */
+#define CHARACTER_COLUMNS \
+    "id, account_id, name, race, class, gender, skin, face, " \
+    "hair_style, hair_color, facial_hair, level, map, x, y, z, orientation"
+
+static const char *STATEMENT_SQL[DB_STMT_COUNT] = {
+    [DB_STMT_GET_ACCOUNT] =
+        "SELECT id, username, salt, verifier, session_key FROM accounts WHERE username = ? COLLATE NOCASE",
+    [DB_STMT_CREATE_ACCOUNT] =
+        "INSERT INTO accounts (username, salt, verifier) VALUES (?, ?, ?)",
+    [DB_STMT_UPDATE_SESSION_KEY] =
+        "UPDATE accounts SET session_key = ? WHERE id = ?",
+    [DB_STMT_GET_CHARACTERS] =
+        "SELECT " CHARACTER_COLUMNS " FROM characters WHERE account_id = ?",
+    [DB_STMT_GET_CHARACTER] =
+        "SELECT " CHARACTER_COLUMNS " FROM characters WHERE id = ?",
+    [DB_STMT_CHARACTER_ID_RANGE] =
+        "SELECT COUNT(*), COALESCE(MIN(id), 0), COALESCE(MAX(id), 0) FROM characters",
+    [DB_STMT_GET_CHARACTER_NAMES] =
+        "SELECT id, name, race, class, gender FROM characters WHERE id BETWEEN ? AND ?",
+    [DB_STMT_CREATE_CHARACTER] =
+        "INSERT INTO characters (account_id, name, race, class, gender, skin, face, "
+        "hair_style, hair_color, facial_hair, level, map, x, y, z, orientation) "
+        "VALUES (?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?, ?)",
+    [DB_STMT_UPDATE_POSITION] =
+        "UPDATE characters SET map = ?, x = ?, y = ?, z = ?, orientation = ? WHERE id = ?",
+    [DB_STMT_DELETE_CHARACTER] =
+        "DELETE FROM characters WHERE id = ?",
+    [DB_STMT_BEGIN] = "BEGIN IMMEDIATE",
+    [DB_STMT_COMMIT] = "COMMIT",
+    [DB_STMT_ROLLBACK] = "ROLLBACK",
+};
+
+static void finalize_statements(sqlite3_stmt **statements, int count) {
+    for (int i = 0; i < count; i++) {
+        if (statements[i]) {
+            sqlite3_finalize(statements[i]);
+            statements[i] = NULL;
+        }
+    }
+}
+
+static result_t prepare_statements(sqlite3 *db, sqlite3_stmt **statements, int count) {
+    for (int i = 0; i < count; i++) {
+        int rc = sqlite3_prepare_v3(db, STATEMENT_SQL[i], -1, SQLITE_PREPARE_PERSISTENT,
+                                    &statements[i], NULL);
+        if (rc != SQLITE_OK) {
+            LOG_ERROR("Database", "Failed to prepare statement: %s", sqlite3_errmsg(db));
+            finalize_statements(statements, count);
+            return ERR_DATABASE;
+        }
+    }
+    return OK;
+}
+
+/* Reader connection of the calling thread */
+static THREAD_LOCAL db_connection_t *t_reader = NULL;
+
+static db_connection_t *reader_open(void) {
+    db_connection_t *conn = ALLOC(db_connection_t);
+    if (!conn) return NULL;
+
+    int rc = sqlite3_open_v2(g_database->path, &conn->db, SQLITE_OPEN_READONLY | SQLITE_OPEN_NOMUTEX, NULL);
+    if (rc != SQLITE_OK ||
+        apply_profile(conn->db, &g_profile, false) != OK ||
+        prepare_statements(conn->db, conn->statements, DB_STMT_READ_COUNT) != OK) {
+        LOG_ERROR("Database", "Failed to open reader connection: %s", sqlite3_errmsg(conn->db));
+        sqlite3_close(conn->db);
+        free(conn);
+        return NULL;
+    }
+    return conn;
+}
+
+static void reader_close(db_connection_t *conn) {
+    finalize_statements(conn->statements, DB_STMT_READ_COUNT);
+    sqlite3_close(conn->db);
+    free(conn);
+}
+
+/* The calling thread's reader: reused from the idle list or opened.
+ * NULL when there is none to be had (in-memory database, open failure). */
+static db_connection_t *reader_acquire(void) {
+    if (t_reader) return t_reader;
+    if (strcmp(g_database->path, ":memory:") == 0) return NULL;
+
+    mutex_lock(&g_database->pool_lock);
+    db_connection_t *conn = g_database->idle;
+    if (conn) {
+        g_database->idle = conn->next_idle;
+    }
+    mutex_unlock(&g_database->pool_lock);
+
+    if (!conn) {
+        conn = reader_open();
+        if (!conn) return NULL;
+
+        mutex_lock(&g_database->pool_lock);
+        conn->next = g_database->readers;
+        g_database->readers = conn;
+        g_database->reader_count++;
+        mutex_unlock(&g_database->pool_lock);
+    }
+
+    t_reader = conn;
+    return conn;
+}
+
+static void sqlite_thread_release(void) {
+    if (!t_reader || !g_database) return;
+
+    mutex_lock(&g_database->pool_lock);
+    t_reader->next_idle = g_database->idle;
+    g_database->idle = t_reader;
+    mutex_unlock(&g_database->pool_lock);
+    t_reader = NULL;
+}
+
+/* Take a cached read statement from the thread's reader connection, or
+ * from the writer connection (under its lock) if the thread has none */
+static sqlite3_stmt *statement_begin(db_statement_t id) {
+    db_connection_t *conn = reader_acquire();
+    if (conn) return conn->statements[id];
+
+    mutex_lock(&g_database->lock);
+    return g_database->statements[id];
+}
+
+/* Reset the statement for its next use and release the connection */
+static void statement_end(sqlite3_stmt *stmt) {
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+    if (sqlite3_db_handle(stmt) == g_database->db) {
+        mutex_unlock(&g_database->lock);
+    }
+}
+
+/* Fill a character from a row of CHARACTER_COLUMNS */
+static void read_character_row(sqlite3_stmt *stmt, character_t *character) {
+    character->id = sqlite3_column_int(stmt, 0);
+    character->account_id = sqlite3_column_int(stmt, 1);
+    safe_strncpy(character->name, (const char*)sqlite3_column_text(stmt, 2), sizeof(character->name));
+    character->race = (uint8_t)sqlite3_column_int(stmt, 3);
+    character->char_class = (uint8_t)sqlite3_column_int(stmt, 4);
+    character->gender = (uint8_t)sqlite3_column_int(stmt, 5);
+    character->skin = (uint8_t)sqlite3_column_int(stmt, 6);
+    character->face = (uint8_t)sqlite3_column_int(stmt, 7);
+    character->hair_style = (uint8_t)sqlite3_column_int(stmt, 8);
+    character->hair_color = (uint8_t)sqlite3_column_int(stmt, 9);
+    character->facial_hair = (uint8_t)sqlite3_column_int(stmt, 10);
+    character->level = (uint8_t)sqlite3_column_int(stmt, 11);
+    character->map = sqlite3_column_int(stmt, 12);
+    character->x = (float)sqlite3_column_double(stmt, 13);
+    character->y = (float)sqlite3_column_double(stmt, 14);
+    character->z = (float)sqlite3_column_double(stmt, 15);
+    character->orientation = (float)sqlite3_column_double(stmt, 16);
+}
+
+/* Run a batch of SQL, logging what failed */
+static result_t exec_sql(sqlite3 *db, const char *sql, const char *what) {
+    char *err_msg = NULL;
+    if (sqlite3_exec(db, sql, NULL, NULL, &err_msg) != SQLITE_OK) {
+        LOG_ERROR("Database", "Failed to %s: %s", what, err_msg);
+        sqlite3_free(err_msg);
+        return ERR_DATABASE;
+    }
+    return OK;
+}
+
+static int schema_version(sqlite3 *db) {
+    int version = -1;
+    sqlite3_stmt *stmt;
+    if (sqlite3_prepare_v2(db, "SELECT COALESCE(MAX(version), 0) FROM schema_version", -1, &stmt, NULL) == SQLITE_OK) {
+        if (sqlite3_step(stmt) == SQLITE_ROW) {
+            version = sqlite3_column_int(stmt, 0);
+        }
+        sqlite3_finalize(stmt);
+    }
+    return version;
+}
+
+static result_t apply_migration(sqlite3 *db, const db_migration_t *migration) {
+    if (exec_sql(db, "BEGIN IMMEDIATE", "begin migration") != OK) return ERR_DATABASE;
+
+    sqlite3_stmt *stmt = NULL;
+    bool ok = exec_sql(db, migration->sql, "apply migration") == OK &&
+              sqlite3_prepare_v2(db, "INSERT INTO schema_version (version, description, applied_at) "
+                                 "VALUES (?, ?, strftime('%s', 'now'))", -1, &stmt, NULL) == SQLITE_OK;
+    if (ok) {
+        sqlite3_bind_int(stmt, 1, migration->version);
+        sqlite3_bind_text(stmt, 2, migration->description, -1, SQLITE_STATIC);
+        ok = sqlite3_step(stmt) == SQLITE_DONE;
+    }
+    sqlite3_finalize(stmt);
+
+    if (!ok || exec_sql(db, "COMMIT", "commit migration") != OK) {
+        sqlite3_exec(db, "ROLLBACK", NULL, NULL, NULL);
+        return ERR_DATABASE;
+    }
+    return OK;
+}
+
+/* Bring the schema up to date, running only the steps it has not had */
+static result_t migrate(sqlite3 *db) {
+    if (exec_sql(db, SCHEMA_VERSION_SQL, "create schema_version") != OK) return ERR_DATABASE;
+
+    int version = schema_version(db);
+    int latest = MIGRATIONS[MIGRATION_COUNT - 1].version;
+    if (version < 0) return ERR_DATABASE;
+    if (version > latest) {
+        LOG_ERROR("Database", "Schema version %d is newer than this server knows (%d)", version, latest);
+        return ERR_DATABASE;
+    }
+
+    for (int i = 0; i < MIGRATION_COUNT; i++) {
+        const db_migration_t *migration = &MIGRATIONS[i];
+        if (migration->version <= version) continue;
+
+        if (apply_migration(db, migration) != OK) {
+            LOG_ERROR("Database", "Migration %d (%s) failed", migration->version, migration->description);
+            return ERR_DATABASE;
+        }
+        LOG_INFO("Database", "Migrated schema to version %d: %s", migration->version, migration->description);
+    }
+    return OK;
+}
+
+static result_t sqlite_open(const char *path) {
+    if (g_database) {
+        return ERR_ALREADY_EXISTS;
+    }
+
+    g_database = ALLOC(database_t);
+    if (!g_database) return ERR_MEMORY;
+
+    safe_strncpy(g_database->path, path, sizeof(g_database->path));
+
+    int rc = sqlite3_open(path, &g_database->db);
+    if (rc != SQLITE_OK) {
+        LOG_ERROR("Database", "Failed to open database: %s", sqlite3_errmsg(g_database->db));
+        sqlite3_close(g_database->db);
+        FREE(g_database);
+        return ERR_DATABASE;
+    }
+
+    if (apply_profile(g_database->db, &g_profile, true) != OK) {
+        sqlite3_close(g_database->db);
+        FREE(g_database);
+        return ERR_DATABASE;
+    }
+
+    if (migrate(g_database->db) != OK) {
+        sqlite3_close(g_database->db);
+        FREE(g_database);
+        return ERR_DATABASE;
+    }
+
+    if (prepare_statements(g_database->db, g_database->statements, DB_STMT_COUNT) != OK) {
+        sqlite3_close(g_database->db);
+        FREE(g_database);
+        return ERR_DATABASE;
+    }
+
+    mutex_init(&g_database->lock);
+    mutex_init(&g_database->pool_lock);
+
+    LOG_INFO("Database", "Opened %s (profile %s, %d statements cached)", path, g_profile.name, DB_STMT_COUNT);
+    return OK;
+}
+
+static void sqlite_close(void) {
+    if (!g_database) return;
+
+    sqlite_thread_release();
+
+    /* Readers still held by running threads are left open */
+    int in_use = g_database->reader_count;
+    for (db_connection_t *conn = g_database->idle, *next; conn; conn = next) {
+        next = conn->next_idle;
+        reader_close(conn);
+        in_use--;
+    }
+    if (in_use > 0) {
+        LOG_INFO("Database", "%d reader connections still in use, leaving them open", in_use);
+    }
+    LOG_INFO("Database", "Closed %d reader connections", g_database->reader_count - in_use);
+
+    finalize_statements(g_database->statements, DB_STMT_COUNT);
+    if (g_database->db) {
+        sqlite3_close(g_database->db);
+    }
+    mutex_destroy(&g_database->pool_lock);
+    mutex_destroy(&g_database->lock);
+    FREE(g_database);
+}
+
+static result_t sqlite_get_account(const char *username, account_t *account) {
+    account_init(account);
+
+    sqlite3_stmt *stmt = statement_begin(DB_STMT_GET_ACCOUNT);
+    sqlite3_bind_text(stmt, 1, username, -1, SQLITE_STATIC);
+
+    result_t result = ERR_NOT_FOUND;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        account->id = sqlite3_column_int(stmt, 0);
+        safe_strncpy(account->username, (const char*)sqlite3_column_text(stmt, 1), sizeof(account->username));
+
+        const void *salt = sqlite3_column_blob(stmt, 2);
+        int salt_size = sqlite3_column_bytes(stmt, 2);
+        if (salt && salt_size == SRP6_SALT_SIZE) {
+            memcpy(account->salt, salt, SRP6_SALT_SIZE);
+        }
+
+        const void *verifier = sqlite3_column_blob(stmt, 3);
+        int verifier_size = sqlite3_column_bytes(stmt, 3);
+        if (verifier && verifier_size == SRP6_VERIFIER_SIZE) {
+            memcpy(account->verifier, verifier, SRP6_VERIFIER_SIZE);
+        }
+
+        const void *session_key = sqlite3_column_blob(stmt, 4);
+        int session_key_size = sqlite3_column_bytes(stmt, 4);
+        if (session_key && session_key_size == SRP6_SESSION_KEY_SIZE) {
+            memcpy(account->session_key, session_key, SRP6_SESSION_KEY_SIZE);
+            account->has_session_key = true;
+        }
+
+        result = OK;
+    }
+
+    statement_end(stmt);
+    return result;
+}
+
+/* A read loop ended on something other than SQLITE_DONE */
+static result_t read_failed(sqlite3_stmt *stmt, const char *what) {
+    LOG_ERROR("Database", "Failed to read %s: %s", what, sqlite3_errmsg(sqlite3_db_handle(stmt)));
+    return ERR_DATABASE;
+}
+
+static result_t sqlite_get_characters(int account_id, character_list_t *list) {
+    sqlite3_stmt *stmt = statement_begin(DB_STMT_GET_CHARACTERS);
+    sqlite3_bind_int(stmt, 1, account_id);
+
+    /* A partial list would be cached as the whole account */
+    result_t result = OK;
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        character_t character;
+        character_init(&character);
+        read_character_row(stmt, &character);
+        if (character_list_add(list, &character) != OK) {
+            result = ERR_MEMORY;
+            break;
+        }
+    }
+    if (result == OK && rc != SQLITE_DONE) {
+        result = read_failed(stmt, "characters");
+    }
+
+    statement_end(stmt);
+    return result;
+}
+
+static result_t sqlite_get_character(int character_id, character_t *character) {
+    character_init(character);
+
+    sqlite3_stmt *stmt = statement_begin(DB_STMT_GET_CHARACTER);
+    sqlite3_bind_int(stmt, 1, character_id);
+
+    result_t result = ERR_NOT_FOUND;
+    int rc = sqlite3_step(stmt);
+    if (rc == SQLITE_ROW) {
+        read_character_row(stmt, character);
+        result = OK;
+    } else if (rc != SQLITE_DONE) {
+        result = read_failed(stmt, "character");
+    }
+
+    statement_end(stmt);
+    return result;
+}
+
+static result_t sqlite_character_id_range(int *count, int *first_id, int *last_id) {
+    sqlite3_stmt *stmt = statement_begin(DB_STMT_CHARACTER_ID_RANGE);
+
+    result_t result = ERR_DATABASE;
+    if (sqlite3_step(stmt) == SQLITE_ROW) {
+        *count = sqlite3_column_int(stmt, 0);
+        *first_id = sqlite3_column_int(stmt, 1);
+        *last_id = sqlite3_column_int(stmt, 2);
+        result = OK;
+    }
+
+    statement_end(stmt);
+    return result;
+}
+
+static result_t sqlite_get_character_names(int first_id, int last_id, storage_name_fn fn, void *ctx) {
+    sqlite3_stmt *stmt = statement_begin(DB_STMT_GET_CHARACTER_NAMES);
+    sqlite3_bind_int(stmt, 1, first_id);
+    sqlite3_bind_int(stmt, 2, last_id);
+
+    int rc;
+    while ((rc = sqlite3_step(stmt)) == SQLITE_ROW) {
+        character_name_t name;
+        name.id = sqlite3_column_int(stmt, 0);
+        safe_strncpy(name.name, (const char*)sqlite3_column_text(stmt, 1), sizeof(name.name));
+        name.race = (uint8_t)sqlite3_column_int(stmt, 2);
+        name.char_class = (uint8_t)sqlite3_column_int(stmt, 3);
+        name.gender = (uint8_t)sqlite3_column_int(stmt, 4);
+        fn(&name, ctx);
+    }
+    result_t result = rc == SQLITE_DONE ? OK : read_failed(stmt, "character names");
+
+    statement_end(stmt);
+    return result;
+}
+
+/* Writes, on the writer connection. The writer thread holds it (and an
+ * open transaction) from write_begin to write_commit. */
+
+static void statement_reset(sqlite3_stmt *stmt) {
+    sqlite3_reset(stmt);
+    sqlite3_clear_bindings(stmt);
+}
+
+/* Step a write statement and reset it */
+static result_t statement_step_done(sqlite3_stmt *stmt, const char *what) {
+    result_t result = OK;
+    if (sqlite3_step(stmt) != SQLITE_DONE) {
+        LOG_ERROR("Database", "Failed to %s: %s", what, sqlite3_errmsg(g_database->db));
+        result = ERR_DATABASE;
+    }
+    statement_reset(stmt);
+    return result;
+}
+
+static result_t sqlite_create_account(account_t *account) {
+    sqlite3_stmt *stmt = g_database->statements[DB_STMT_CREATE_ACCOUNT];
+    sqlite3_bind_text(stmt, 1, account->username, -1, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 2, account->salt, SRP6_SALT_SIZE, SQLITE_STATIC);
+    sqlite3_bind_blob(stmt, 3, account->verifier, SRP6_VERIFIER_SIZE, SQLITE_STATIC);
+
+    result_t result = statement_step_done(stmt, "create account");
+    if (result == OK) {
+        account->id = (int)sqlite3_last_insert_rowid(g_database->db);
+    }
+    return result;
+}
+
+static result_t sqlite_update_session_key(int account_id, const uint8_t session_key[SRP6_SESSION_KEY_SIZE]) {
+    sqlite3_stmt *stmt = g_database->statements[DB_STMT_UPDATE_SESSION_KEY];
+    sqlite3_bind_blob(stmt, 1, session_key, SRP6_SESSION_KEY_SIZE, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 2, account_id);
+    return statement_step_done(stmt, "update session key");
+}
+
+static result_t sqlite_create_character(character_t *character) {
+    sqlite3_stmt *stmt = g_database->statements[DB_STMT_CREATE_CHARACTER];
+    sqlite3_bind_int(stmt, 1, character->account_id);
+    sqlite3_bind_text(stmt, 2, character->name, -1, SQLITE_STATIC);
+    sqlite3_bind_int(stmt, 3, character->race);
+    sqlite3_bind_int(stmt, 4, character->char_class);
+    sqlite3_bind_int(stmt, 5, character->gender);
+    sqlite3_bind_int(stmt, 6, character->skin);
+    sqlite3_bind_int(stmt, 7, character->face);
+    sqlite3_bind_int(stmt, 8, character->hair_style);
+    sqlite3_bind_int(stmt, 9, character->hair_color);
+    sqlite3_bind_int(stmt, 10, character->facial_hair);
+    sqlite3_bind_int(stmt, 11, character->level);
+    sqlite3_bind_int(stmt, 12, character->map);
+    sqlite3_bind_double(stmt, 13, character->x);
+    sqlite3_bind_double(stmt, 14, character->y);
+    sqlite3_bind_double(stmt, 15, character->z);
+    sqlite3_bind_double(stmt, 16, character->orientation);
+
+    result_t result = statement_step_done(stmt, "create character");
+    if (result == OK) {
+        character->id = (int)sqlite3_last_insert_rowid(g_database->db);
+    }
+    return result;
+}
+
+static result_t sqlite_update_character_position(int character_id, int map, float x, float y, float z, float orientation) {
+    sqlite3_stmt *stmt = g_database->statements[DB_STMT_UPDATE_POSITION];
+    sqlite3_bind_int(stmt, 1, map);
+    sqlite3_bind_double(stmt, 2, x);
+    sqlite3_bind_double(stmt, 3, y);
+    sqlite3_bind_double(stmt, 4, z);
+    sqlite3_bind_double(stmt, 5, orientation);
+    sqlite3_bind_int(stmt, 6, character_id);
+    return statement_step_done(stmt, "update position");
+}
+
+static result_t sqlite_delete_character(int character_id) {
+    sqlite3_stmt *stmt = g_database->statements[DB_STMT_DELETE_CHARACTER];
+    sqlite3_bind_int(stmt, 1, character_id);
+    return statement_step_done(stmt, "delete character");
+}
+
+static result_t sqlite_write_begin(void) {
+    mutex_lock(&g_database->lock);
+    result_t result = statement_step_done(g_database->statements[DB_STMT_BEGIN], "begin transaction");
+    if (result != OK) {
+        mutex_unlock(&g_database->lock);
+    }
+    return result;
+}
+
+static result_t sqlite_write_commit(void) {
+    result_t result = statement_step_done(g_database->statements[DB_STMT_COMMIT], "commit");
+    if (result != OK) {
+        statement_step_done(g_database->statements[DB_STMT_ROLLBACK], "roll back");
+    }
+    mutex_unlock(&g_database->lock);
+    return result;
+}
+
+const storage_backend_t storage_sqlite = {
+    .name = "sqlite",
+    .open = sqlite_open,
+    .close = sqlite_close,
+    .thread_release = sqlite_thread_release,
+    .get_account = sqlite_get_account,
+    .get_characters = sqlite_get_characters,
+    .get_character = sqlite_get_character,
+    .character_id_range = sqlite_character_id_range,
+    .get_character_names = sqlite_get_character_names,
+    .write_begin = sqlite_write_begin,
+    .create_account = sqlite_create_account,
+    .update_session_key = sqlite_update_session_key,
+    .create_character = sqlite_create_character,
+    .update_character_position = sqlite_update_character_position,
+    .delete_character = sqlite_delete_character,
+    .write_commit = sqlite_write_commit,
+};
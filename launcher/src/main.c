@@ -59,8 +59,17 @@ static void *world_server_thread(void *arg) {
 #endif
 
 int main(int argc, char *argv[]) {
-    (void)argc;
-    (void)argv;
+    /* --storage memory runs an ephemeral realm that never touches disk */
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--storage") == 0 && i + 1 < argc) {
+            const storage_backend_t *backend = storage_backend_find(argv[++i]);
+            if (!backend) {
+                LOG_ERROR("AshEmu", "Unknown storage backend: %s", argv[i]);
+                return 1;
+            }
+            database_set_backend(backend);
+        }
+    }
 
     printf("===========================================\n");
     printf("  AshEmu - WoW 2.4.3 Server Emulator\n");
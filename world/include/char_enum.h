@@ -0,0 +1,49 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * char_enum.h - Serialized SMSG_CHAR_ENUM payloads cached per account
+ */
+
+#ifndef CHAR_ENUM_H
+#define CHAR_ENUM_H
+
+#include "common.h"
+#include "arena.h"
+#include "relay.h"
+
+/* Hash buckets (accounts with a session) */
+#define CHAR_ENUM_BUCKETS 1024
+
+/* Enum cache counters */
+typedef struct {
+    uint64_t hits;           /* Enums sent from a cached payload */
+    uint64_t built;          /* Payloads serialized */
+    uint64_t invalidations;  /* Cached payloads dropped */
+    uint64_t evictions;      /* Payloads dropped when the account's last session ended */
+} char_enum_stats_t;
+
+/* Initialize the enum cache */
+void char_enum_init(void);
+
+/* Free all cached payloads */
+void char_enum_shutdown(void);
+
+/* Count an authenticated session of the account; its enum is cached
+ * until the last one ends */
+void char_enum_session_start(int account_id);
+void char_enum_session_end(int account_id);
+
+/* Get an account's SMSG_CHAR_ENUM body (new reference), serializing it on
+ * a miss. scratch holds the character list while building. If the
+ * characters can't be read the body is an empty list, sent but not cached. */
+shared_payload_t *char_enum_get(int account_id, arena_t *scratch);
+
+/* Drop an account's payload. Call after anything shown on the character
+ * screen changes: create, delete, rename, logout save. */
+void char_enum_invalidate(int account_id);
+
+/* Get cache counters */
+void char_enum_get_stats(char_enum_stats_t *stats);
+
+#endif /* CHAR_ENUM_H */
@@ -0,0 +1,58 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * fields.h - Persistent update field values with dirty tracking
+ */
+
+#ifndef FIELDS_H
+#define FIELDS_H
+
+#include "common.h"
+
+/* Number of update fields of a player object (PLAYER_END in update.h) */
+#define FIELD_STORE_SIZE 0x0621
+
+/* Number of 64-bit mask words covering every field */
+#define FIELD_MASK_WORDS ((FIELD_STORE_SIZE + 63) / 64)
+
+/* Current field values of one object */
+typedef struct {
+    uint32_t values[FIELD_STORE_SIZE];
+    uint64_t set_mask[FIELD_MASK_WORDS];    /* Fields sent in create blocks */
+    uint64_t dirty_mask[FIELD_MASK_WORDS];  /* Fields changed since the last values update */
+    uint64_t modified_mask[FIELD_MASK_WORDS]; /* Fields changed since the baseline */
+    bool dirty;
+} field_store_t;
+
+/* Reset every field to unset and clean */
+void field_store_init(field_store_t *store);
+
+/* Set a field, marking it dirty if the value changed */
+void field_store_set_uint32(field_store_t *store, int field, uint32_t value);
+void field_store_set_int32(field_store_t *store, int field, int32_t value);
+void field_store_set_float(field_store_t *store, int field, float value);
+void field_store_set_guid(field_store_t *store, int field, uint64_t value);
+
+/* Set a byte within a field (byte_index 0-3) */
+void field_store_set_byte(field_store_t *store, int field, int byte_index, uint8_t value);
+
+/* Get a field value (0 if out of range) */
+uint32_t field_store_get_uint32(const field_store_t *store, int field);
+
+/* Get a byte within a field */
+uint8_t field_store_get_byte(const field_store_t *store, int field, int byte_index);
+
+/* Check if a field has been set */
+bool field_store_is_set(const field_store_t *store, int field);
+
+/* Check if a field changed since the last clear */
+bool field_store_is_dirty(const field_store_t *store, int field);
+
+/* Forget all pending changes (after a values update went out) */
+void field_store_clear_dirty(field_store_t *store);
+
+/* Take the current values as the baseline (clears dirty and modified masks) */
+void field_store_mark_baseline(field_store_t *store);
+
+#endif /* FIELDS_H */
@@ -0,0 +1,71 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * grid.h - Uniform-cell spatial index for per-map visibility
+ */
+
+#ifndef GRID_H
+#define GRID_H
+
+#include "common.h"
+
+/* Map tiles are 533.33 yards; each tile is split into 8x8 cells */
+#define GRID_TILE_SIZE      533.33333f
+#define GRID_TILES_PER_MAP  64
+#define GRID_CELLS_PER_TILE 8
+#define GRID_CELLS_PER_MAP  (GRID_TILES_PER_MAP * GRID_CELLS_PER_TILE)
+#define GRID_CELL_SIZE      (GRID_TILE_SIZE / GRID_CELLS_PER_TILE)
+
+/* Distance at which players see each other */
+#define WORLD_VISIBILITY_DISTANCE 100.0f
+
+/* Object tracked by the grid (embed in the owning structure) */
+typedef struct grid_object {
+    struct grid_object *prev;
+    struct grid_object *next;
+    void *owner;
+    uint64_t guid;
+    int map;
+    int map_index;   /* -1 when not in any grid */
+    int cell;
+    float x;
+    float y;
+    float z;
+} grid_object_t;
+
+/* Visitor callback, called with the map grid locked */
+typedef void (*grid_visitor_t)(grid_object_t *object, float dist_sq, void *ctx);
+
+/* Initialize grids for all supported maps */
+result_t grid_init(void);
+
+/* Free all grids */
+void grid_shutdown(void);
+
+/* Check if a map has a grid */
+bool grid_has_map(int map);
+
+/* Number of maps with a grid, and the map ID at each index */
+int grid_map_count(void);
+int grid_map_id(int index);
+
+/* Initialize an object (not yet in any grid) */
+void grid_object_init(grid_object_t *object, void *owner, uint64_t guid);
+
+/* Insert object into a map grid */
+result_t grid_add(grid_object_t *object, int map, float x, float y, float z);
+
+/* Remove object from its grid (no-op if not added) */
+void grid_remove(grid_object_t *object);
+
+/* Update object position, returns true if it moved to another cell */
+bool grid_move(grid_object_t *object, float x, float y, float z);
+
+/* Visit every object within range of (x, y), returns number visited */
+int grid_visit(int map, float x, float y, float range, grid_visitor_t visitor, void *ctx);
+
+/* Get number of objects in a map grid */
+int grid_count(int map);
+
+#endif /* GRID_H */
@@ -0,0 +1,54 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * persistence.h - Write-behind player saves on a staggered schedule
+ */
+
+#ifndef PERSISTENCE_H
+#define PERSISTENCE_H
+
+#include "common.h"
+#include "world.h"
+
+/* Default time between saves of a changed player */
+#define PERSISTENCE_SAVE_INTERVAL_MS 60000
+
+/* Default cap on saves one map queues per tick */
+#define PERSISTENCE_MAX_SAVES_PER_TICK 64
+
+/* Save policy */
+typedef struct {
+    uint32_t save_interval_ms;
+    uint32_t max_saves_per_tick;
+} persistence_config_t;
+
+/* Persistence counters */
+typedef struct {
+    uint64_t saves;          /* Saves queued on the writer thread */
+    uint64_t periodic;       /* ... of which by the staggered schedule */
+    uint64_t clean_skipped;  /* Save slots passed because nothing changed */
+    uint64_t deferred;       /* Saves pushed to a later tick by the per-tick cap */
+} persistence_stats_t;
+
+/* Configuration */
+void persistence_config_default(persistence_config_t *config);
+result_t persistence_set_config(const persistence_config_t *config);
+void persistence_get_config(persistence_config_t *config);
+
+/* Get counters */
+void persistence_get_stats(persistence_stats_t *stats);
+
+/* Give a player entering the world its save slot, spread over the interval */
+void persistence_schedule(player_t *player);
+
+/* Queue saves for the players whose slot came up (map thread, each tick) */
+void persistence_update(world_session_t **sessions, int count, uint32_t diff);
+
+/* Queue a save now if the player changed since the last one */
+void persistence_save(player_t *player);
+
+/* Save every changed player (shutdown) */
+void persistence_save_all(world_session_t **sessions, int count);
+
+#endif /* PERSISTENCE_H */
@@ -10,6 +10,13 @@
 
 #include "common.h"
 #include "models.h"
+#include "grid.h"
+#include "fields.h"
+
+/* Create template key: everything login field values depend on besides
+ * the per-player GUID and appearance */
+#define UPDATE_TEMPLATE_KEY(race, char_class, gender, level) \
+    (((uint32_t)(race) << 24) | ((uint32_t)(char_class) << 16) | ((uint32_t)(gender) << 8) | (uint32_t)(level))
 
 /* Player structure */
 typedef struct {
@@ -22,11 +29,29 @@ typedef struct {
     float y;
     float z;
     float orientation;
+    grid_object_t grid;
+    uint32_t heartbeat_count;  /* MSG_MOVE_HEARTBEATs received, drives relay throttling */
+    field_store_t fields;      /* Update field values as last sent to clients */
+    uint32_t template_key;     /* Create template matching the login values */
+    bool save_dirty;           /* Changed since the last save (persistence.c) */
+    int32_t save_timer;        /* ms until the next save slot */
 } player_t;
 
 /* Initialize player from character */
 void player_init(player_t *player, const character_t *character);
 
+/* Change current health */
+void player_set_health(player_t *player, uint32_t health);
+
+/* Change level */
+void player_set_level(player_t *player, uint8_t level);
+
+/* Change stand state (UNIT_STAND_STATE_*) */
+void player_set_stand_state(player_t *player, uint8_t state);
+
+/* Get stand state */
+uint8_t player_get_stand_state(const player_t *player);
+
 /* Get display ID for race/gender combination */
 int player_get_display_id(const player_t *player);
 
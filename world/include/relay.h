@@ -0,0 +1,105 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * relay.h - Movement relay to nearby players with per-tick batching
+ */
+
+#ifndef RELAY_H
+#define RELAY_H
+
+#include "common.h"
+#include "thread.h"
+#include "grid.h"
+
+/* Maximum packets queued for one observer before new ones are dropped */
+#define RELAY_QUEUE_MAX 4096
+
+/* Maximum number of distance tiers for heartbeat throttling */
+#define RELAY_MAX_TIERS 8
+
+/* Observers within `distance` get every `heartbeat_interval`-th heartbeat */
+typedef struct {
+    float distance;
+    uint32_t heartbeat_interval;
+} relay_tier_t;
+
+/* Interest-management policy (tiers sorted by increasing distance) */
+typedef struct {
+    relay_tier_t tiers[RELAY_MAX_TIERS];
+    int tier_count;
+} relay_config_t;
+
+/* Relay counters */
+typedef struct {
+    uint64_t packets_relayed;
+    uint64_t bytes_relayed;
+    uint64_t heartbeats_dropped;
+    uint64_t bytes_saved;
+} relay_stats_t;
+
+/* Reference-counted packet body, serialized once and shared by all observers */
+typedef struct {
+    volatile int32_t refcount;
+    uint16_t opcode;
+    size_t size;
+    uint8_t data[];
+} shared_payload_t;
+
+/* Per-session queue of packets waiting for the next flush */
+typedef struct {
+    shared_payload_t **items;
+    int count;
+    int capacity;
+    mutex_t lock;
+} outbound_queue_t;
+
+/* Create a payload with refcount 1 (data may be NULL to fill in later) */
+shared_payload_t *shared_payload_create(uint16_t opcode, const uint8_t *data, size_t size);
+
+/* Add a reference */
+void shared_payload_retain(shared_payload_t *payload);
+
+/* Drop a reference, freeing the payload when it reaches zero */
+void shared_payload_release(shared_payload_t *payload);
+
+/* Outbound queue functions */
+void outbound_queue_init(outbound_queue_t *queue);
+void outbound_queue_free(outbound_queue_t *queue);
+
+/* Queue a payload (takes a new reference), returns ERR_BUFFER_OVERFLOW if full */
+result_t outbound_queue_push(outbound_queue_t *queue, shared_payload_t *payload);
+
+/* Copy a one-off packet into a new payload and queue it */
+result_t outbound_queue_push_data(outbound_queue_t *queue, uint16_t opcode,
+                                  const uint8_t *data, size_t size);
+
+/* Move all queued payloads into out (caller owns the references), returns count */
+int outbound_queue_take(outbound_queue_t *queue, shared_payload_t ***out, int *out_capacity);
+
+/* Check if a client movement opcode should be relayed to other players */
+bool relay_is_movement_opcode(uint16_t opcode);
+
+/* Check that a client movement payload is well-formed and on the map */
+bool relay_validate_movement(const uint8_t *data, size_t len);
+
+/* Fill in the default tiers (full rate up close, decimated further out) */
+void relay_config_default(relay_config_t *config);
+
+/* Replace the active policy (call before the world server starts) */
+result_t relay_set_config(const relay_config_t *config);
+
+/* Get the active policy */
+void relay_get_config(relay_config_t *config);
+
+/* Get relay counters */
+void relay_get_stats(relay_stats_t *stats);
+
+/* Queue a movement packet for every player that can see the mover.
+ * heartbeat_seq is the mover's running MSG_MOVE_HEARTBEAT count, used to
+ * decimate heartbeats for distant observers. Other opcodes (start, stop,
+ * jump...) are always delivered. */
+result_t relay_movement(const grid_object_t *mover, uint16_t opcode, uint32_t heartbeat_seq,
+                        const uint8_t *data, size_t len);
+
+#endif /* RELAY_H */
@@ -0,0 +1,47 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * scheduler.h - Fixed-rate world tick with one update thread per map
+ */
+
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include "common.h"
+#include "world.h"
+
+/* World tick length */
+#define WORLD_TICK_MS 50
+
+/* Per-map tick metrics */
+typedef struct {
+    int map;
+    int sessions;
+    uint64_t ticks;
+    uint64_t overruns;        /* Ticks that took longer than WORLD_TICK_MS */
+    uint64_t total_tick_us;
+    uint32_t last_tick_us;
+    uint32_t max_tick_us;
+} map_tick_stats_t;
+
+/* Start one update thread per grid map */
+result_t scheduler_start(void);
+
+/* Stop and join all map threads, then free them (after every session has left) */
+void scheduler_stop(void);
+
+/* Hand an in-world session to its map thread */
+result_t scheduler_add_session(world_session_t *session);
+
+/* Take a session away from its map thread and out of the grid.
+ * Blocks until the current tick of that map has finished. */
+void scheduler_remove_session(world_session_t *session);
+
+/* Number of map threads */
+int scheduler_map_count(void);
+
+/* Get metrics for the map thread at index */
+result_t scheduler_get_stats(int index, map_tick_stats_t *stats);
+
+#endif /* SCHEDULER_H */
@@ -205,10 +205,14 @@
 /* Maximum number of update fields we track (increased for TBC) */
 #define MAX_UPDATE_FIELDS 1600
 
-/* Update builder structure */
+/* Number of 64-bit words in the update mask */
+#define UPDATE_MASK_WORDS ((MAX_UPDATE_FIELDS + 63) / 64)
+
+/* Update builder structure (a field value is only meaningful if its mask
+ * bit is set, so initializing just clears the mask) */
 typedef struct {
+    uint64_t mask[UPDATE_MASK_WORDS];
     uint32_t fields[MAX_UPDATE_FIELDS];
-    bool field_set[MAX_UPDATE_FIELDS];
     int max_field;
 } update_builder_t;
 
@@ -230,12 +234,47 @@ void update_set_float(update_builder_t *builder, int field, float value);
 /* Set a byte within a uint32 field (byteIndex 0-3) */
 void update_set_byte(update_builder_t *builder, int field, int byte_index, uint8_t value);
 
+/* Load every set field of a field store into a builder */
+void update_builder_load(update_builder_t *builder, const field_store_t *fields);
+
+/* Write the builder's update mask and field values */
+result_t update_write_fields(packet_writer_t *packet, const update_builder_t *builder);
+
+/* Write the SMSG_UPDATE_OBJECT prefix (block count, transport flag) */
+result_t update_write_packet_header(packet_writer_t *packet, uint32_t block_count);
+
+/* Write a player create block up to the update fields (type, movement, high GUID) */
+result_t update_write_create_header(packet_writer_t *packet, const player_t *player, bool self);
+
+/* Write a complete player create block */
+result_t update_write_create_block(update_builder_t *builder, const player_t *player,
+                                   bool self, packet_writer_t *packet);
+
+/* Write a values block with the player's dirty fields,
+ * returns ERR_NOT_FOUND if nothing changed */
+result_t update_write_values_block(const player_t *player, packet_writer_t *packet);
+
+/* Write a block removing objects from the client's view */
+result_t update_write_out_of_range_block(const uint64_t *guids, int count,
+                                         packet_writer_t *packet);
+
+/* Fill a player's field store with its login values (nothing left dirty) */
+void update_init_player_fields(player_t *player);
+
 /* Build SMSG_UPDATE_OBJECT packet for player creation */
 result_t update_build_create_packet(update_builder_t *builder,
                                             const player_t *player,
                                             bool self,
                                             packet_writer_t *packet);
 
+/* Build SMSG_UPDATE_OBJECT packet carrying only the player's dirty fields,
+ * returns ERR_NOT_FOUND if nothing changed */
+result_t update_build_values_packet(const player_t *player, packet_writer_t *packet);
+
+/* Build SMSG_UPDATE_OBJECT packet removing objects from the client's view */
+result_t update_build_out_of_range_packet(const uint64_t *guids, int count,
+                                          packet_writer_t *packet);
+
 /* Backwards compatibility macros for old field names */
 #define UF_OBJECT_FIELD_GUID              OBJECT_FIELD_GUID
 #define UF_OBJECT_FIELD_TYPE              OBJECT_FIELD_TYPE
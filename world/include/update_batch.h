@@ -0,0 +1,64 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * update_batch.h - Per-observer accumulation of update blocks
+ */
+
+#ifndef UPDATE_BATCH_H
+#define UPDATE_BATCH_H
+
+#include "common.h"
+#include "player.h"
+#include "packet.h"
+
+/* Largest SMSG_UPDATE_OBJECT body a batch grows to before it is sent */
+#define UPDATE_BATCH_MAX_SIZE 65536
+
+/* Receives each finished SMSG_UPDATE_OBJECT body */
+typedef result_t (*update_batch_sink_t)(void *ctx, const uint8_t *data, size_t size);
+
+/* Update blocks for one observer, sent as few packets as possible */
+typedef struct {
+    packet_writer_t packet;     /* Block count + transport flag, then the blocks */
+    uint32_t block_count;
+    update_batch_sink_t sink;
+    void *sink_ctx;
+} update_batch_t;
+
+/* Batch counters */
+typedef struct {
+    uint64_t packets;  /* SMSG_UPDATE_OBJECT bodies emitted */
+    uint64_t blocks;   /* Blocks carried by them */
+    uint64_t splits;   /* Packets sealed early because of the size limit */
+} update_batch_stats_t;
+
+/* Initialize a batch that hands finished packets to sink */
+result_t update_batch_init(update_batch_t *batch, update_batch_sink_t sink, void *sink_ctx);
+
+/* Free a batch (pending blocks are dropped) */
+void update_batch_free(update_batch_t *batch);
+
+/* Drop pending blocks */
+void update_batch_reset(update_batch_t *batch);
+
+/* Append a player create block (from the template cache) */
+result_t update_batch_add_create(update_batch_t *batch, const player_t *player, bool self);
+
+/* Append a values block with the player's dirty fields,
+ * returns ERR_NOT_FOUND if nothing changed */
+result_t update_batch_add_values(update_batch_t *batch, const player_t *player);
+
+/* Append an out-of-range block */
+result_t update_batch_add_out_of_range(update_batch_t *batch, const uint64_t *guids, int count);
+
+/* Append an already serialized block (shared between observers) */
+result_t update_batch_add_block(update_batch_t *batch, const uint8_t *data, size_t size);
+
+/* Send everything pending as one packet */
+result_t update_batch_flush(update_batch_t *batch);
+
+/* Get batch counters */
+void update_batch_get_stats(update_batch_stats_t *stats);
+
+#endif /* UPDATE_BATCH_H */
@@ -0,0 +1,53 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * update_compress.h - SMSG_COMPRESSED_UPDATE_OBJECT encoding
+ */
+
+#ifndef UPDATE_COMPRESS_H
+#define UPDATE_COMPRESS_H
+
+#include "common.h"
+#include "packet.h"
+
+/* Update packets smaller than this are sent as is */
+#define UPDATE_COMPRESS_DEFAULT_THRESHOLD 256
+
+/* zlib level (1 = fastest, 9 = smallest) */
+#define UPDATE_COMPRESS_DEFAULT_LEVEL 1
+
+/* Compression policy */
+typedef struct {
+    bool enabled;
+    size_t threshold;
+    int level;
+} update_compress_config_t;
+
+/* Compression counters */
+typedef struct {
+    uint64_t packets_compressed;
+    uint64_t packets_skipped;   /* Above the threshold but did not shrink */
+    uint64_t bytes_in;          /* Uncompressed size of compressed packets */
+    uint64_t bytes_out;         /* Compressed size, including the size prefix */
+    uint64_t compress_us;       /* Time spent in deflate */
+} update_compress_stats_t;
+
+/* Fill in the defaults */
+void update_compress_config_default(update_compress_config_t *config);
+
+/* Replace the active policy (call before the world server starts) */
+result_t update_compress_set_config(const update_compress_config_t *config);
+
+/* Get compression counters */
+void update_compress_get_stats(update_compress_stats_t *stats);
+
+/* Compress an SMSG_UPDATE_OBJECT body into an SMSG_COMPRESSED_UPDATE_OBJECT
+ * body (uint32 size + zlib stream). Returns false, leaving out untouched,
+ * if the packet is below the threshold, would not shrink, or out can't grow. */
+bool update_compress(const uint8_t *data, size_t size, packet_writer_t *out);
+
+/* Release the calling thread's deflate stream (call before a thread exits) */
+void update_compress_thread_cleanup(void);
+
+#endif /* UPDATE_COMPRESS_H */
@@ -0,0 +1,39 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * update_template.h - Cached create blocks per race/class/gender/level
+ */
+
+#ifndef UPDATE_TEMPLATE_H
+#define UPDATE_TEMPLATE_H
+
+#include "common.h"
+#include "player.h"
+#include "packet.h"
+
+/* Template cache counters */
+typedef struct {
+    uint64_t hits;       /* Create blocks copied from a template */
+    uint64_t built;      /* Templates built */
+    uint64_t fallbacks;  /* Create blocks built field by field */
+} update_template_stats_t;
+
+/* Initialize the template cache */
+void update_template_init(void);
+
+/* Free all cached templates */
+void update_template_shutdown(void);
+
+/* Write a player create block. The update fields are copied from the
+ * template for the player's login race/class/gender/level and only
+ * per-player and since-changed fields are patched in. */
+result_t update_template_write_create(const player_t *player, bool self, packet_writer_t *packet);
+
+/* Build SMSG_UPDATE_OBJECT carrying a single templated create block */
+result_t update_template_build_create(const player_t *player, bool self, packet_writer_t *packet);
+
+/* Get cache counters */
+void update_template_get_stats(update_template_stats_t *stats);
+
+#endif /* UPDATE_TEMPLATE_H */
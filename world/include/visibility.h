@@ -0,0 +1,28 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * visibility.h - Per-session set of visible players
+ */
+
+#ifndef VISIBILITY_H
+#define VISIBILITY_H
+
+#include "common.h"
+#include "world.h"
+
+/* Recompute which players the session can see and add create /
+ * out-of-range blocks for the difference to its update batch.
+ * Called from the map thread. */
+void visibility_update(world_session_t *session);
+
+/* Whether the client has been sent a create block for guid */
+bool visibility_contains(const world_session_t *session, uint64_t guid);
+
+/* Forget every visible object (the client drops them itself on logout) */
+void visibility_clear(world_session_t *session);
+
+/* Free the visible set */
+void visibility_free(world_session_t *session);
+
+#endif /* VISIBILITY_H */
@@ -13,10 +13,27 @@
 #include "network.h"
 #include "database.h"
 #include "player.h"
+#include "packet.h"
+#include "relay.h"
+#include "update_batch.h"
+#include "thread.h"
+#include "arena.h"
 
 /* World server port */
 #define WORLD_SERVER_PORT 8085
 
+/* Server packet header: 2-byte big-endian size + opcode. Packets whose size
+ * (payload + opcode) exceeds SERVER_PACKET_SMALL_MAX set the top bit of the
+ * first byte and carry a 3-byte size instead. */
+#define SERVER_HEADER_SIZE        4
+#define SERVER_LARGE_HEADER_SIZE  5
+#define SERVER_LARGE_PACKET_FLAG  0x80
+#define SERVER_PACKET_SMALL_MAX   0x7FFF
+#define SERVER_PACKET_MAX         (0x7FFFFF - 2)  /* Largest payload a header can describe */
+
+/* Interval between SMSG_TIME_SYNC_REQ while in world */
+#define TIME_SYNC_INTERVAL_MS 10000
+
 /* World session state */
 typedef enum {
     WORLD_STATE_INIT,
@@ -25,6 +42,21 @@ typedef enum {
     WORLD_STATE_IN_WORLD
 } world_state_t;
 
+/* Client packet waiting for the map thread */
+typedef struct {
+    uint16_t opcode;
+    uint8_t *data;
+    size_t size;
+} queued_packet_t;
+
+/* Inbound packet queue, filled by the I/O thread */
+typedef struct {
+    queued_packet_t *items;
+    int count;
+    int capacity;
+    mutex_t lock;
+} packet_queue_t;
+
 /* World session context */
 typedef struct {
     client_t *client;
@@ -36,8 +68,31 @@ typedef struct {
     world_state_t state;
     uint32_t server_seed;
     uint32_t time_sync_counter;
+    mutex_t send_lock;            /* Serializes header encryption and socket writes */
+    outbound_queue_t outbound;    /* Relayed packets waiting for the next flush */
+    packet_writer_t send_buffer;  /* Reused buffer for batched flushes */
+    shared_payload_t **flush_items;
+    int flush_capacity;
+    mutex_t handler_lock;         /* Serializes packet handling between I/O and map thread */
+    packet_queue_t inbound;       /* Packets for the map thread while in world */
+    queued_packet_t *process_items;
+    int process_capacity;
+    volatile bool in_map;         /* Owned by a map thread, guarded by inbound.lock */
+    uint32_t time_sync_timer;
+    uint64_t *visible;            /* Sorted GUIDs the client has been sent */
+    int visible_count;
+    update_batch_t update_batch;  /* Update blocks for this client, sent at the next flush */
+    arena_t arena;                /* Handler scratch memory, reset after every packet */
+    uint8_t *recv_buffer;         /* Payload of the packet being read (I/O thread only) */
+    size_t recv_capacity;
 } world_session_t;
 
+/* Set up the session allocator (before the first world_session_create) */
+void world_session_cache_init(void);
+
+/* Log its occupancy and release it once no session is left */
+void world_session_cache_shutdown(void);
+
 /* Create world session */
 world_session_t *world_session_create(client_t *client);
 
@@ -47,6 +102,23 @@ void world_session_free(world_session_t *session);
 /* Handle world session (blocking, runs until disconnect) */
 void world_session_handle(world_session_t *session);
 
+/* Send all queued outbound packets to the client in a single write */
+result_t world_session_flush(world_session_t *session);
+
+/* Queue an SMSG_UPDATE_OBJECT body for the next flush (compressed when worthwhile) */
+result_t world_session_queue_update(world_session_t *session, const uint8_t *data, size_t size);
+
+/* Handle queued packets, run timers and send changed fields
+ * (map thread, once per tick) */
+void world_session_update(world_session_t *session, uint32_t diff);
+
+/* Start routing packets through the map thread (called with the map locked) */
+void world_session_enter_map(world_session_t *session);
+
+/* Stop routing packets through the map thread, handle anything still queued
+ * and leave the grid (called with the map locked) */
+void world_session_leave_map(world_session_t *session);
+
 /* World server functions */
 
 /* Start world server (blocking call) */
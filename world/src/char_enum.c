@@ -0,0 +1,214 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * char_enum.c - Serialized SMSG_CHAR_ENUM payloads cached per account
+ *
+ * The character screen asks for the enum every time it is shown, and the
+ * answer only changes when one of the account's characters does. The body
+ * is serialized once into a shared payload and kept until invalidated, so
+ * a repeated enum is a single send of the cached buffer. Entries exist only
+ * while the account has a session, so the table is bounded by the number
+ * of players online.
+ */
+
+#include "char_enum.h"
+#include "database.h"
+#include "opcodes.h"
+#include "packet.h"
+#include "thread.h"
+
+/* Equipment slots in the enum (TBC: 19 equipment + 1 bag) */
+#define CHAR_ENUM_EQUIPMENT_SLOTS 20
+
+typedef struct char_enum_entry {
+    struct char_enum_entry *next;
+    int account_id;
+    int sessions;               /* Authenticated sessions of the account */
+    shared_payload_t *payload;  /* NULL until built, and after invalidation */
+} char_enum_entry_t;
+
+static char_enum_entry_t *g_entries[CHAR_ENUM_BUCKETS];
+static mutex_t g_enum_lock;
+static char_enum_stats_t g_enum_stats;
+
+/* Bumped by every invalidation, so a payload built from rows read before
+ * one is not cached */
+static uint64_t g_generation;
+
+static uint32_t account_bucket(int account_id) {
+    uint32_t h = (uint32_t)account_id * 2654435761u;
+    return (h ^ (h >> 16)) % CHAR_ENUM_BUCKETS;
+}
+
+void char_enum_init(void) {
+    mutex_init(&g_enum_lock);
+    memset(g_entries, 0, sizeof(g_entries));
+    memset(&g_enum_stats, 0, sizeof(g_enum_stats));
+    g_generation = 0;
+}
+
+void char_enum_shutdown(void) {
+    for (int i = 0; i < CHAR_ENUM_BUCKETS; i++) {
+        char_enum_entry_t *entry = g_entries[i];
+        while (entry) {
+            char_enum_entry_t *next = entry->next;
+            if (entry->payload) shared_payload_release(entry->payload);
+            free(entry);
+            entry = next;
+        }
+        g_entries[i] = NULL;
+    }
+    mutex_destroy(&g_enum_lock);
+}
+
+void char_enum_get_stats(char_enum_stats_t *stats) {
+    mutex_lock(&g_enum_lock);
+    *stats = g_enum_stats;
+    mutex_unlock(&g_enum_lock);
+}
+
+static void write_character(packet_writer_t *packet, const character_t *c) {
+    write_uint64(packet, (uint64_t)c->id);  /* GUID */
+    write_cstring(packet, c->name);
+    write_uint8(packet, c->race);
+    write_uint8(packet, c->char_class);
+    write_uint8(packet, c->gender);
+    write_uint8(packet, c->skin);
+    write_uint8(packet, c->face);
+    write_uint8(packet, c->hair_style);
+    write_uint8(packet, c->hair_color);
+    write_uint8(packet, c->facial_hair);
+    write_uint8(packet, c->level);
+    write_uint32(packet, (uint32_t)c->map);  /* Zone ID (using map for simplicity) */
+    write_uint32(packet, (uint32_t)c->map);  /* Map ID */
+    write_float(packet, c->x);
+    write_float(packet, c->y);
+    write_float(packet, c->z);
+    write_uint32(packet, 0);  /* Guild ID */
+
+    write_uint32(packet, 0);  /* Character flags */
+    write_uint8(packet, 1);   /* At login flags (1 = first login resting) */
+    write_uint32(packet, 0);  /* Pet display ID */
+    write_uint32(packet, 0);  /* Pet level */
+    write_uint32(packet, 0);  /* Pet family */
+
+    for (int j = 0; j < CHAR_ENUM_EQUIPMENT_SLOTS; j++) {
+        write_uint32(packet, 0);  /* Display ID */
+        write_uint8(packet, 0);   /* Inventory type */
+        write_uint32(packet, 0);  /* Enchant aura ID */
+    }
+}
+
+static char_enum_entry_t **find_entry(int account_id) {
+    char_enum_entry_t **link = &g_entries[account_bucket(account_id)];
+    while (*link && (*link)->account_id != account_id) {
+        link = &(*link)->next;
+    }
+    return link;
+}
+
+void char_enum_session_start(int account_id) {
+    mutex_lock(&g_enum_lock);
+    char_enum_entry_t **link = find_entry(account_id);
+    if (*link) {
+        (*link)->sessions++;
+    } else {
+        char_enum_entry_t *entry = ALLOC(char_enum_entry_t);
+        if (entry) {
+            entry->account_id = account_id;
+            entry->sessions = 1;
+            entry->payload = NULL;
+            entry->next = NULL;
+            *link = entry;
+        }
+    }
+    mutex_unlock(&g_enum_lock);
+}
+
+void char_enum_session_end(int account_id) {
+    char_enum_entry_t *removed = NULL;
+
+    mutex_lock(&g_enum_lock);
+    char_enum_entry_t **link = find_entry(account_id);
+    if (*link && --(*link)->sessions == 0) {
+        removed = *link;
+        *link = removed->next;
+        if (removed->payload) g_enum_stats.evictions++;
+    }
+    mutex_unlock(&g_enum_lock);
+
+    if (removed) {
+        if (removed->payload) shared_payload_release(removed->payload);
+        free(removed);
+    }
+}
+
+/* Serialize the enum; on a failed read it is empty and must not be cached */
+static shared_payload_t *char_enum_build(int account_id, arena_t *scratch, bool *complete) {
+    character_list_t characters;
+    character_list_init_arena(&characters, scratch);
+    *complete = database_get_characters(account_id, &characters) == OK;
+    if (!*complete) {
+        LOG_ERROR("WorldServer", "Failed to load characters for account_id=%d", account_id);
+        characters.count = 0;
+    }
+
+    packet_writer_t packet;
+    writer_init(&packet);
+    write_uint8(&packet, (uint8_t)characters.count);
+    for (int i = 0; i < characters.count; i++) {
+        write_character(&packet, &characters.items[i]);
+    }
+
+    shared_payload_t *payload = shared_payload_create(SMSG_CHAR_ENUM, writer_data(&packet), writer_size(&packet));
+    writer_free(&packet);
+    character_list_free(&characters);
+    return payload;
+}
+
+shared_payload_t *char_enum_get(int account_id, arena_t *scratch) {
+    mutex_lock(&g_enum_lock);
+    char_enum_entry_t *entry = *find_entry(account_id);
+    if (entry && entry->payload) {
+        shared_payload_t *payload = entry->payload;
+        shared_payload_retain(payload);
+        g_enum_stats.hits++;
+        mutex_unlock(&g_enum_lock);
+        return payload;
+    }
+    uint64_t generation = g_generation;
+    mutex_unlock(&g_enum_lock);
+
+    /* Build outside the lock; the database read may go to disk */
+    bool complete;
+    shared_payload_t *payload = char_enum_build(account_id, scratch, &complete);
+    if (!payload) return NULL;
+
+    mutex_lock(&g_enum_lock);
+    g_enum_stats.built++;
+    /* Only cached for accounts with a session; the entry may have gone */
+    entry = *find_entry(account_id);
+    if (complete && generation == g_generation && entry && !entry->payload) {
+        shared_payload_retain(payload);
+        entry->payload = payload;
+    }
+    mutex_unlock(&g_enum_lock);
+    return payload;
+}
+
+void char_enum_invalidate(int account_id) {
+    shared_payload_t *removed = NULL;
+
+    mutex_lock(&g_enum_lock);
+    g_generation++;
+    char_enum_entry_t *entry = *find_entry(account_id);
+    if (entry && entry->payload) {
+        removed = entry->payload;
+        entry->payload = NULL;
+        g_enum_stats.invalidations++;
+    }
+    mutex_unlock(&g_enum_lock);
+
+    if (removed) shared_payload_release(removed);
+}
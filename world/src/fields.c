@@ -0,0 +1,86 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * fields.c - Persistent update field values with dirty tracking
+ */
+
+#include "fields.h"
+
+#define FIELD_WORD(field) ((field) / 64)
+#define FIELD_BIT(field) (1ull << ((field) % 64))
+
+void field_store_init(field_store_t *store) {
+    memset(store, 0, sizeof(*store));
+}
+
+void field_store_set_uint32(field_store_t *store, int field, uint32_t value) {
+    if (field < 0 || field >= FIELD_STORE_SIZE) return;
+
+    uint64_t bit = FIELD_BIT(field);
+    bool was_set = (store->set_mask[FIELD_WORD(field)] & bit) != 0;
+
+    if (was_set && store->values[field] == value) return;
+
+    store->values[field] = value;
+    store->set_mask[FIELD_WORD(field)] |= bit;
+    store->dirty_mask[FIELD_WORD(field)] |= bit;
+    store->modified_mask[FIELD_WORD(field)] |= bit;
+    store->dirty = true;
+}
+
+void field_store_set_int32(field_store_t *store, int field, int32_t value) {
+    field_store_set_uint32(store, field, (uint32_t)value);
+}
+
+void field_store_set_float(field_store_t *store, int field, float value) {
+    union { uint32_t i; float f; } u;
+    u.f = value;
+    field_store_set_uint32(store, field, u.i);
+}
+
+void field_store_set_guid(field_store_t *store, int field, uint64_t value) {
+    field_store_set_uint32(store, field, (uint32_t)(value & 0xFFFFFFFF));
+    field_store_set_uint32(store, field + 1, (uint32_t)(value >> 32));
+}
+
+void field_store_set_byte(field_store_t *store, int field, int byte_index, uint8_t value) {
+    if (field < 0 || field >= FIELD_STORE_SIZE) return;
+    if (byte_index < 0 || byte_index > 3) return;
+
+    uint32_t mask = 0xFFu << (byte_index * 8);
+    uint32_t current = store->values[field];
+    field_store_set_uint32(store, field, (current & ~mask) | ((uint32_t)value << (byte_index * 8)));
+}
+
+uint32_t field_store_get_uint32(const field_store_t *store, int field) {
+    if (field < 0 || field >= FIELD_STORE_SIZE) return 0;
+    return store->values[field];
+}
+
+uint8_t field_store_get_byte(const field_store_t *store, int field, int byte_index) {
+    if (byte_index < 0 || byte_index > 3) return 0;
+    return (uint8_t)(field_store_get_uint32(store, field) >> (byte_index * 8));
+}
+
+bool field_store_is_set(const field_store_t *store, int field) {
+    if (field < 0 || field >= FIELD_STORE_SIZE) return false;
+    return (store->set_mask[FIELD_WORD(field)] & FIELD_BIT(field)) != 0;
+}
+
+bool field_store_is_dirty(const field_store_t *store, int field) {
+    if (field < 0 || field >= FIELD_STORE_SIZE) return false;
+    return (store->dirty_mask[FIELD_WORD(field)] & FIELD_BIT(field)) != 0;
+}
+
+void field_store_clear_dirty(field_store_t *store) {
+    if (!store->dirty) return;
+    memset(store->dirty_mask, 0, sizeof(store->dirty_mask));
+    store->dirty = false;
+}
+
+void field_store_mark_baseline(field_store_t *store) {
+    memset(store->dirty_mask, 0, sizeof(store->dirty_mask));
+    memset(store->modified_mask, 0, sizeof(store->modified_mask));
+    store->dirty = false;
+}
@@ -0,0 +1,230 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * grid.c - Uniform-cell spatial index for per-map visibility
+ *
+ * Each map is covered by a 512x512 array of cells (66.67 yards each).
+ * Every cell holds an intrusive doubly-linked list of objects, so moving
+ * between cells is an O(1) unlink/link and a range query only touches the
+ * handful of cells overlapping the query circle.
+ */
+
+#include "grid.h"
+#include "thread.h"
+
+/* Maps with a grid (continents used by the starting positions) */
+static const int GRID_MAPS[] = { 0, 1, 530 };
+#define NUM_GRID_MAPS ((int)(sizeof(GRID_MAPS) / sizeof(GRID_MAPS[0])))
+
+/* Half the map extent: coordinates run from -GRID_HALF_EXTENT to +GRID_HALF_EXTENT */
+#define GRID_HALF_EXTENT (GRID_TILE_SIZE * GRID_TILES_PER_MAP / 2.0f)
+
+/* Per-map grid */
+typedef struct {
+    int map;
+    grid_object_t **cells;
+    int count;
+    mutex_t lock;
+} map_grid_t;
+
+static map_grid_t g_grids[NUM_GRID_MAPS];
+static bool g_grid_initialized = false;
+
+static int grid_map_index(int map) {
+    for (int i = 0; i < NUM_GRID_MAPS; i++) {
+        if (GRID_MAPS[i] == map) return i;
+    }
+    return -1;
+}
+
+/* Convert a world coordinate to a cell column/row, clamped to the map */
+static int grid_coord(float value) {
+    float offset = value + GRID_HALF_EXTENT;
+    if (offset < 0.0f) return 0;
+    int c = (int)(offset / GRID_CELL_SIZE);
+    if (c >= GRID_CELLS_PER_MAP) return GRID_CELLS_PER_MAP - 1;
+    return c;
+}
+
+static int grid_cell_index(float x, float y) {
+    return grid_coord(y) * GRID_CELLS_PER_MAP + grid_coord(x);
+}
+
+static void cell_link(map_grid_t *grid, grid_object_t *object) {
+    grid_object_t **head = &grid->cells[object->cell];
+    object->prev = NULL;
+    object->next = *head;
+    if (*head) {
+        (*head)->prev = object;
+    }
+    *head = object;
+}
+
+static void cell_unlink(map_grid_t *grid, grid_object_t *object) {
+    if (object->prev) {
+        object->prev->next = object->next;
+    } else {
+        grid->cells[object->cell] = object->next;
+    }
+    if (object->next) {
+        object->next->prev = object->prev;
+    }
+    object->prev = NULL;
+    object->next = NULL;
+}
+
+result_t grid_init(void) {
+    if (g_grid_initialized) return ERR_ALREADY_EXISTS;
+
+    for (int i = 0; i < NUM_GRID_MAPS; i++) {
+        map_grid_t *grid = &g_grids[i];
+        grid->map = GRID_MAPS[i];
+        grid->count = 0;
+        grid->cells = ALLOC_ARRAY(grid_object_t*, GRID_CELLS_PER_MAP * GRID_CELLS_PER_MAP);
+        if (!grid->cells) {
+            for (int j = 0; j < i; j++) {
+                FREE(g_grids[j].cells);
+                mutex_destroy(&g_grids[j].lock);
+            }
+            return ERR_MEMORY;
+        }
+        mutex_init(&grid->lock);
+    }
+
+    g_grid_initialized = true;
+    LOG_INFO("Grid", "Initialized %d map grids (%dx%d cells of %.1f yards)",
+             NUM_GRID_MAPS, GRID_CELLS_PER_MAP, GRID_CELLS_PER_MAP, GRID_CELL_SIZE);
+    return OK;
+}
+
+void grid_shutdown(void) {
+    if (!g_grid_initialized) return;
+
+    for (int i = 0; i < NUM_GRID_MAPS; i++) {
+        FREE(g_grids[i].cells);
+        mutex_destroy(&g_grids[i].lock);
+    }
+    g_grid_initialized = false;
+}
+
+bool grid_has_map(int map) {
+    return grid_map_index(map) >= 0;
+}
+
+int grid_map_count(void) {
+    return NUM_GRID_MAPS;
+}
+
+int grid_map_id(int index) {
+    if (index < 0 || index >= NUM_GRID_MAPS) return -1;
+    return GRID_MAPS[index];
+}
+
+void grid_object_init(grid_object_t *object, void *owner, uint64_t guid) {
+    memset(object, 0, sizeof(grid_object_t));
+    object->owner = owner;
+    object->guid = guid;
+    object->map_index = -1;
+}
+
+result_t grid_add(grid_object_t *object, int map, float x, float y, float z) {
+    if (!g_grid_initialized) return ERR_INVALID_PARAM;
+    if (object->map_index >= 0) return ERR_ALREADY_EXISTS;
+
+    int index = grid_map_index(map);
+    if (index < 0) return ERR_NOT_FOUND;
+
+    map_grid_t *grid = &g_grids[index];
+
+    mutex_lock(&grid->lock);
+    object->map = map;
+    object->map_index = index;
+    object->x = x;
+    object->y = y;
+    object->z = z;
+    object->cell = grid_cell_index(x, y);
+    cell_link(grid, object);
+    grid->count++;
+    mutex_unlock(&grid->lock);
+
+    return OK;
+}
+
+void grid_remove(grid_object_t *object) {
+    if (object->map_index < 0) return;
+
+    map_grid_t *grid = &g_grids[object->map_index];
+
+    mutex_lock(&grid->lock);
+    cell_unlink(grid, object);
+    grid->count--;
+    object->map_index = -1;
+    mutex_unlock(&grid->lock);
+}
+
+bool grid_move(grid_object_t *object, float x, float y, float z) {
+    if (object->map_index < 0) return false;
+
+    map_grid_t *grid = &g_grids[object->map_index];
+    int cell = grid_cell_index(x, y);
+    bool changed = false;
+
+    mutex_lock(&grid->lock);
+    object->x = x;
+    object->y = y;
+    object->z = z;
+    if (cell != object->cell) {
+        cell_unlink(grid, object);
+        object->cell = cell;
+        cell_link(grid, object);
+        changed = true;
+    }
+    mutex_unlock(&grid->lock);
+
+    return changed;
+}
+
+int grid_visit(int map, float x, float y, float range, grid_visitor_t visitor, void *ctx) {
+    int index = grid_map_index(map);
+    if (!g_grid_initialized || index < 0) return 0;
+
+    map_grid_t *grid = &g_grids[index];
+    float range_sq = range * range;
+
+    int min_x = grid_coord(x - range);
+    int max_x = grid_coord(x + range);
+    int min_y = grid_coord(y - range);
+    int max_y = grid_coord(y + range);
+
+    int visited = 0;
+
+    mutex_lock(&grid->lock);
+    for (int cy = min_y; cy <= max_y; cy++) {
+        for (int cx = min_x; cx <= max_x; cx++) {
+            grid_object_t *object = grid->cells[cy * GRID_CELLS_PER_MAP + cx];
+            for (; object; object = object->next) {
+                float dx = object->x - x;
+                float dy = object->y - y;
+                float dist_sq = dx * dx + dy * dy;
+                if (dist_sq <= range_sq) {
+                    visitor(object, dist_sq, ctx);
+                    visited++;
+                }
+            }
+        }
+    }
+    mutex_unlock(&grid->lock);
+
+    return visited;
+}
+
+int grid_count(int map) {
+    int index = grid_map_index(map);
+    if (!g_grid_initialized || index < 0) return 0;
+
+    mutex_lock(&g_grids[index].lock);
+    int count = g_grids[index].count;
+    mutex_unlock(&g_grids[index].lock);
+    return count;
+}
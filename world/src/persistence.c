@@ -0,0 +1,94 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * persistence.c - Write-behind player saves on a staggered schedule
+ *
+ * Handlers only mark a player dirty. Each player gets a save slot somewhere
+ * in the save interval (derived from its GUID), so saves trickle out evenly
+ * instead of arriving all at once; when a slot comes up and the player has
+ * changed, its state is queued on the database writer thread, which commits
+ * everything queued together in one transaction.
+ */
+
+#include "persistence.h"
+#include "thread.h"
+
+static persistence_config_t g_config = { PERSISTENCE_SAVE_INTERVAL_MS, PERSISTENCE_MAX_SAVES_PER_TICK };
+static persistence_stats_t g_stats;
+
+void persistence_config_default(persistence_config_t *config) {
+    config->save_interval_ms = PERSISTENCE_SAVE_INTERVAL_MS;
+    config->max_saves_per_tick = PERSISTENCE_MAX_SAVES_PER_TICK;
+}
+
+result_t persistence_set_config(const persistence_config_t *config) {
+    if (config->save_interval_ms == 0 || config->max_saves_per_tick == 0) return ERR_INVALID_PARAM;
+    if (config->save_interval_ms > INT32_MAX) return ERR_INVALID_PARAM;
+
+    g_config = *config;
+    return OK;
+}
+
+void persistence_get_config(persistence_config_t *config) {
+    *config = g_config;
+}
+
+void persistence_get_stats(persistence_stats_t *stats) {
+    *stats = g_stats;
+}
+
+void persistence_schedule(player_t *player) {
+    /* Multiplicative hash so consecutive GUIDs land far apart */
+    uint32_t slot = (uint32_t)player->guid * 2654435761u;
+    player->save_timer = (int32_t)(slot % g_config.save_interval_ms) + 1;
+}
+
+void persistence_save(player_t *player) {
+    if (!player->save_dirty) return;
+
+    if (database_save_character_position(player->character.id, player->map, player->x,
+                                         player->y, player->z, player->orientation) == OK) {
+        player->save_dirty = false;
+        atomic_add_uint64(&g_stats.saves, 1);
+    }
+}
+
+void persistence_update(world_session_t **sessions, int count, uint32_t diff) {
+    uint32_t budget = g_config.max_saves_per_tick;
+    int32_t interval = (int32_t)g_config.save_interval_ms;
+
+    for (int i = 0; i < count; i++) {
+        if (!sessions[i]->has_player) continue;
+
+        player_t *player = &sessions[i]->player;
+        player->save_timer -= (int32_t)diff;
+        if (player->save_timer > 0) continue;
+
+        if (player->save_dirty) {
+            /* Over the cap: stay due and go out on a later tick */
+            if (budget == 0) {
+                atomic_add_uint64(&g_stats.deferred, 1);
+                continue;
+            }
+            budget--;
+            persistence_save(player);
+            atomic_add_uint64(&g_stats.periodic, 1);
+        } else {
+            atomic_add_uint64(&g_stats.clean_skipped, 1);
+        }
+
+        player->save_timer += interval;
+        if (player->save_timer <= 0) {
+            player->save_timer = interval;
+        }
+    }
+}
+
+void persistence_save_all(world_session_t **sessions, int count) {
+    for (int i = 0; i < count; i++) {
+        if (sessions[i]->has_player) {
+            persistence_save(&sessions[i]->player);
+        }
+    }
+}
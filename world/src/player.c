@@ -7,6 +7,7 @@
 
 #include "player.h"
 #include "positions.h"
+#include "update.h"
 
 void player_init(player_t *player, const character_t *character) {
     player->character = *character;
@@ -16,11 +17,36 @@ void player_init(player_t *player, const character_t *character) {
     player->y = character->y;
     player->z = character->z;
     player->orientation = character->orientation;
+    grid_object_init(&player->grid, NULL, player->guid);
+    player->heartbeat_count = 0;
+    player->save_dirty = false;
+    player->save_timer = 0;
 
     /* Get zone/area from start position based on race */
     const start_position_t *start = get_start_position(character->race);
     player->zone_id = start->zone_id;
     player->area_id = start->area_id;
+
+    update_init_player_fields(player);
+}
+
+void player_set_health(player_t *player, uint32_t health) {
+    uint32_t max_health = field_store_get_uint32(&player->fields, UNIT_FIELD_MAXHEALTH);
+    if (health > max_health) health = max_health;
+    field_store_set_uint32(&player->fields, UNIT_FIELD_HEALTH, health);
+}
+
+void player_set_level(player_t *player, uint8_t level) {
+    player->character.level = level;
+    field_store_set_uint32(&player->fields, UNIT_FIELD_LEVEL, level);
+}
+
+void player_set_stand_state(player_t *player, uint8_t state) {
+    field_store_set_byte(&player->fields, UNIT_FIELD_BYTES_1, 0, state);
+}
+
+uint8_t player_get_stand_state(const player_t *player) {
+    return field_store_get_byte(&player->fields, UNIT_FIELD_BYTES_1, 0);
 }
 
 int player_get_display_id(const player_t *player) {
@@ -0,0 +1,272 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * relay.c - Movement relay to nearby players with per-tick batching
+ *
+ * A movement packet is serialized once into a shared payload (packed GUID
+ * of the mover + the client's movement info) and a reference is queued for
+ * every observer in visibility range. Each observer's queue is flushed once
+ * per world tick as a single send, so per-recipient work is just the encrypted
+ * 4-byte header.
+ *
+ * Heartbeats are throttled by distance: each tier only passes every Nth
+ * heartbeat of the mover, while state changes always go through.
+ */
+
+#include "relay.h"
+#include "world.h"
+#include "packet.h"
+#include "opcodes.h"
+#include "grid.h"
+#include "visibility.h"
+#include <math.h>  /* isfinite */
+
+/* Initial outbound queue capacity */
+#define QUEUE_INITIAL_CAPACITY 16
+
+/* Offset of the position floats in a client movement payload */
+#define MOVEMENT_POSITION_OFFSET 9
+
+/* Size of a server packet header (size + opcode) */
+#define RELAY_HEADER_SIZE 4
+
+/* Default tiers: every heartbeat within 30 yards, every 2nd within 60,
+ * every 4th out to the edge of sight */
+#define DEFAULT_RELAY_CONFIG \
+    { { { 30.0f, 1 }, { 60.0f, 2 }, { WORLD_VISIBILITY_DISTANCE, 4 } }, 3 }
+
+static relay_config_t g_relay_config = DEFAULT_RELAY_CONFIG;
+static relay_stats_t g_relay_stats;
+
+void relay_config_default(relay_config_t *config) {
+    relay_config_t defaults = DEFAULT_RELAY_CONFIG;
+    *config = defaults;
+}
+
+result_t relay_set_config(const relay_config_t *config) {
+    if (config->tier_count < 1 || config->tier_count > RELAY_MAX_TIERS) return ERR_INVALID_PARAM;
+
+    for (int i = 0; i < config->tier_count; i++) {
+        if (config->tiers[i].heartbeat_interval == 0) return ERR_INVALID_PARAM;
+        if (i > 0 && config->tiers[i].distance <= config->tiers[i - 1].distance) return ERR_INVALID_PARAM;
+    }
+
+    g_relay_config = *config;
+    return OK;
+}
+
+void relay_get_config(relay_config_t *config) {
+    *config = g_relay_config;
+}
+
+void relay_get_stats(relay_stats_t *stats) {
+    *stats = g_relay_stats;
+}
+
+/* Heartbeat interval for an observer at the given squared distance */
+static uint32_t relay_heartbeat_interval(float dist_sq) {
+    for (int i = 0; i < g_relay_config.tier_count; i++) {
+        float d = g_relay_config.tiers[i].distance;
+        if (dist_sq <= d * d) {
+            return g_relay_config.tiers[i].heartbeat_interval;
+        }
+    }
+    /* Beyond the last tier: use its rate */
+    return g_relay_config.tiers[g_relay_config.tier_count - 1].heartbeat_interval;
+}
+
+shared_payload_t *shared_payload_create(uint16_t opcode, const uint8_t *data, size_t size) {
+    shared_payload_t *payload = (shared_payload_t*)malloc(sizeof(shared_payload_t) + size);
+    if (!payload) return NULL;
+
+    payload->refcount = 1;
+    payload->opcode = opcode;
+    payload->size = size;
+    if (data && size > 0) {
+        memcpy(payload->data, data, size);
+    }
+    return payload;
+}
+
+void shared_payload_retain(shared_payload_t *payload) {
+    atomic_add_int32(&payload->refcount, 1);
+}
+
+void shared_payload_release(shared_payload_t *payload) {
+    if (!payload) return;
+    if (atomic_add_int32(&payload->refcount, -1) == 0) {
+        free(payload);
+    }
+}
+
+void outbound_queue_init(outbound_queue_t *queue) {
+    queue->items = NULL;
+    queue->count = 0;
+    queue->capacity = 0;
+    mutex_init(&queue->lock);
+}
+
+void outbound_queue_free(outbound_queue_t *queue) {
+    for (int i = 0; i < queue->count; i++) {
+        shared_payload_release(queue->items[i]);
+    }
+    FREE(queue->items);
+    queue->count = 0;
+    queue->capacity = 0;
+    mutex_destroy(&queue->lock);
+}
+
+result_t outbound_queue_push(outbound_queue_t *queue, shared_payload_t *payload) {
+    result_t result = OK;
+
+    mutex_lock(&queue->lock);
+    if (queue->count >= RELAY_QUEUE_MAX) {
+        result = ERR_BUFFER_OVERFLOW;
+    } else {
+        if (queue->count >= queue->capacity) {
+            int new_capacity = queue->capacity == 0 ? QUEUE_INITIAL_CAPACITY : queue->capacity * 2;
+            shared_payload_t **new_items = (shared_payload_t**)realloc(
+                queue->items, new_capacity * sizeof(shared_payload_t*));
+            if (!new_items) {
+                result = ERR_MEMORY;
+            } else {
+                queue->items = new_items;
+                queue->capacity = new_capacity;
+            }
+        }
+        if (result == OK) {
+            shared_payload_retain(payload);
+            queue->items[queue->count++] = payload;
+        }
+    }
+    mutex_unlock(&queue->lock);
+
+    return result;
+}
+
+result_t outbound_queue_push_data(outbound_queue_t *queue, uint16_t opcode,
+                                  const uint8_t *data, size_t size) {
+    shared_payload_t *payload = shared_payload_create(opcode, data, size);
+    if (!payload) return ERR_MEMORY;
+
+    result_t result = outbound_queue_push(queue, payload);
+    shared_payload_release(payload);
+    return result;
+}
+
+int outbound_queue_take(outbound_queue_t *queue, shared_payload_t ***out, int *out_capacity) {
+    mutex_lock(&queue->lock);
+    int count = queue->count;
+    if (count > 0) {
+        /* Swap arrays so the queue keeps the caller's (now empty) buffer */
+        shared_payload_t **items = queue->items;
+        int capacity = queue->capacity;
+        queue->items = *out;
+        queue->capacity = *out_capacity;
+        queue->count = 0;
+        *out = items;
+        *out_capacity = capacity;
+    }
+    mutex_unlock(&queue->lock);
+    return count;
+}
+
+bool relay_is_movement_opcode(uint16_t opcode) {
+    switch (opcode) {
+        case MSG_MOVE_START_FORWARD:
+        case MSG_MOVE_START_BACKWARD:
+        case MSG_MOVE_STOP:
+        case MSG_MOVE_START_STRAFE_LEFT:
+        case MSG_MOVE_START_STRAFE_RIGHT:
+        case MSG_MOVE_STOP_STRAFE:
+        case MSG_MOVE_JUMP:
+        case MSG_MOVE_START_TURN_LEFT:
+        case MSG_MOVE_START_TURN_RIGHT:
+        case MSG_MOVE_STOP_TURN:
+        case MSG_MOVE_START_PITCH_UP:
+        case MSG_MOVE_START_PITCH_DOWN:
+        case MSG_MOVE_STOP_PITCH:
+        case MSG_MOVE_SET_RUN_MODE:
+        case MSG_MOVE_SET_WALK_MODE:
+        case MSG_MOVE_FALL_LAND:
+        case MSG_MOVE_START_SWIM:
+        case MSG_MOVE_STOP_SWIM:
+        case MSG_MOVE_SET_FACING:
+        case MSG_MOVE_SET_PITCH:
+        case MSG_MOVE_HEARTBEAT:
+            return true;
+        default:
+            return false;
+    }
+}
+
+bool relay_validate_movement(const uint8_t *data, size_t len) {
+    if (!data) return false;
+
+    packet_reader_t reader;
+    reader_init(&reader, data, len);
+    if (!reader_require(&reader, MOVEMENT_POSITION_OFFSET + 16)) return false;
+    reader_skip(&reader, MOVEMENT_POSITION_OFFSET);
+
+    float max_coord = GRID_TILE_SIZE * GRID_TILES_PER_MAP / 2.0f;
+    for (int i = 0; i < 4; i++) {
+        float value = read_float_unchecked(&reader);
+        if (!isfinite(value)) return false;
+        if (i < 3 && (value > max_coord || value < -max_coord)) return false;
+    }
+    return true;
+}
+
+/* Grid visitor: queue the shared payload for every player in range */
+typedef struct {
+    const grid_object_t *mover;
+    shared_payload_t *payload;
+    bool heartbeat;
+    uint32_t heartbeat_seq;
+} relay_ctx_t;
+
+static void relay_visitor(grid_object_t *object, float dist_sq, void *ctx) {
+    relay_ctx_t *relay = (relay_ctx_t*)ctx;
+    if (!object->owner) return;
+    if (object == relay->mover) return;
+
+    /* Clients can't apply movement for an object they were never sent */
+    world_session_t *observer = (world_session_t*)object->owner;
+    if (!visibility_contains(observer, relay->mover->guid)) return;
+
+    uint64_t packet_size = RELAY_HEADER_SIZE + relay->payload->size;
+
+    if (relay->heartbeat && relay->heartbeat_seq % relay_heartbeat_interval(dist_sq) != 0) {
+        atomic_add_uint64(&g_relay_stats.heartbeats_dropped, 1);
+        atomic_add_uint64(&g_relay_stats.bytes_saved, packet_size);
+        return;
+    }
+
+    if (outbound_queue_push(&observer->outbound, relay->payload) == OK) {
+        atomic_add_uint64(&g_relay_stats.packets_relayed, 1);
+        atomic_add_uint64(&g_relay_stats.bytes_relayed, packet_size);
+    }
+}
+
+result_t relay_movement(const grid_object_t *mover, uint16_t opcode, uint32_t heartbeat_seq,
+                        const uint8_t *data, size_t len) {
+    if (mover->map_index < 0) return ERR_INVALID_PARAM;
+
+    /* Serialize once: packed GUID + client movement info */
+    packet_writer_t body;
+    if (writer_init(&body) != OK) return ERR_MEMORY;
+    write_packed_guid(&body, mover->guid);
+    write_bytes(&body, data, len);
+
+    shared_payload_t *payload = shared_payload_create(opcode, writer_data(&body), writer_size(&body));
+    writer_free(&body);
+    if (!payload) return ERR_MEMORY;
+
+    relay_ctx_t ctx = { mover, payload, opcode == MSG_MOVE_HEARTBEAT, heartbeat_seq };
+    grid_visit(mover->map, mover->x, mover->y, WORLD_VISIBILITY_DISTANCE, relay_visitor, &ctx);
+
+    /* Drop the creation reference; observers hold their own */
+    shared_payload_release(payload);
+    return OK;
+}
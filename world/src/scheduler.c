@@ -0,0 +1,237 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * scheduler.c - Fixed-rate world tick with one update thread per map
+ *
+ * Every grid map gets its own thread running a fixed-timestep loop. Session
+ * I/O threads only read packets and queue them; each tick the map thread
+ * drains the queues of its sessions, runs their timers, recomputes who can
+ * see whom and flushes every outbound queue. The map lock is held for the
+ * whole tick, so sessions can only join or leave between ticks.
+ */
+
+#include "scheduler.h"
+#include "grid.h"
+#include "visibility.h"
+#include "thread.h"
+#include "update_compress.h"
+#include "packet.h"
+#include "persistence.h"
+
+/* Map update thread state */
+typedef struct {
+    int map;
+    thread_t thread;
+    mutex_t lock;
+    world_session_t **sessions;
+    int count;
+    int capacity;
+    map_tick_stats_t stats;
+} map_updater_t;
+
+static map_updater_t *g_maps = NULL;
+static int g_map_count = 0;
+static volatile bool g_scheduler_running = false;
+
+static map_updater_t *scheduler_find_map(int map) {
+    for (int i = 0; i < g_map_count; i++) {
+        if (g_maps[i].map == map) return &g_maps[i];
+    }
+    return NULL;
+}
+
+static void map_remove_at(map_updater_t *m, int index) {
+    m->sessions[index] = m->sessions[--m->count];
+}
+
+/* One world tick, called with the map lock held */
+static void map_tick(map_updater_t *m, uint32_t diff) {
+    /* Incoming packets and timers */
+    for (int i = 0; i < m->count; i++) {
+        world_session_update(m->sessions[i], diff);
+    }
+
+    /* Sessions that logged out this tick go back to their I/O thread */
+    for (int i = m->count - 1; i >= 0; i--) {
+        world_session_t *session = m->sessions[i];
+        if (session->state != WORLD_STATE_IN_WORLD) {
+            map_remove_at(m, i);
+            world_session_leave_map(session);
+        }
+    }
+
+    /* Staggered saves of changed players */
+    persistence_update(m->sessions, m->count, diff);
+
+    /* Creates and out-of-range updates for players entering/leaving sight */
+    for (int i = 0; i < m->count; i++) {
+        visibility_update(m->sessions[i]);
+    }
+
+    /* Everything queued this tick goes out as one write per session */
+    for (int i = 0; i < m->count; i++) {
+        world_session_flush(m->sessions[i]);
+    }
+}
+
+static void map_thread(void *arg) {
+    map_updater_t *m = (map_updater_t*)arg;
+    const uint64_t tick_us = WORLD_TICK_MS * 1000;
+
+    uint64_t last = get_time_us();
+    uint64_t next = last + tick_us;
+
+    while (g_scheduler_running) {
+        uint64_t start = get_time_us();
+        uint32_t diff = (uint32_t)((start - last) / 1000);
+        last += (uint64_t)diff * 1000;
+
+        mutex_lock(&m->lock);
+        map_tick(m, diff);
+
+        uint64_t end = get_time_us();
+        uint32_t elapsed = (uint32_t)(end - start);
+        m->stats.sessions = m->count;
+        m->stats.ticks++;
+        m->stats.total_tick_us += elapsed;
+        m->stats.last_tick_us = elapsed;
+        if (elapsed > m->stats.max_tick_us) {
+            m->stats.max_tick_us = elapsed;
+        }
+        if (end > next) {
+            m->stats.overruns++;
+        }
+        mutex_unlock(&m->lock);
+
+        if (end < next) {
+            thread_sleep_ms((uint32_t)((next - end + 999) / 1000));
+            next += tick_us;
+        } else {
+            /* Overran: start the next tick now rather than trying to catch up */
+            next = end + tick_us;
+        }
+    }
+
+    update_compress_thread_cleanup();
+    packet_pool_trim();
+    database_thread_release();
+}
+
+result_t scheduler_start(void) {
+    if (g_scheduler_running) return ERR_ALREADY_EXISTS;
+
+    g_map_count = grid_map_count();
+    g_maps = ALLOC_ARRAY(map_updater_t, g_map_count);
+    if (!g_maps) return ERR_MEMORY;
+
+    g_scheduler_running = true;
+
+    for (int i = 0; i < g_map_count; i++) {
+        map_updater_t *m = &g_maps[i];
+        m->map = grid_map_id(i);
+        m->stats.map = m->map;
+        mutex_init(&m->lock);
+
+        if (thread_create(&m->thread, map_thread, m) != OK) {
+            LOG_ERROR("Scheduler", "Failed to start update thread for map %d", m->map);
+            g_map_count = i + 1;
+            scheduler_stop();
+            return ERR_MEMORY;
+        }
+    }
+
+    LOG_INFO("Scheduler", "Started %d map threads (%d ms tick)", g_map_count, WORLD_TICK_MS);
+    return OK;
+}
+
+void scheduler_stop(void) {
+    if (!g_maps) return;
+
+    g_scheduler_running = false;
+
+    for (int i = 0; i < g_map_count; i++) {
+        map_updater_t *m = &g_maps[i];
+        if (m->thread) {
+            thread_join(m->thread);
+        }
+
+        /* Players still in the world get their last changes saved */
+        mutex_lock(&m->lock);
+        persistence_save_all(m->sessions, m->count);
+        mutex_unlock(&m->lock);
+
+        uint64_t avg = m->stats.ticks ? m->stats.total_tick_us / m->stats.ticks : 0;
+        LOG_INFO("Scheduler", "Map %d: %llu ticks, avg %llu us, max %u us, %llu overruns",
+                 m->map, (unsigned long long)m->stats.ticks, (unsigned long long)avg,
+                 m->stats.max_tick_us, (unsigned long long)m->stats.overruns);
+    }
+
+    /* World shutdown has already waited for every session thread */
+    for (int i = 0; i < g_map_count; i++) {
+        FREE(g_maps[i].sessions);
+        mutex_destroy(&g_maps[i].lock);
+    }
+    FREE(g_maps);
+    g_map_count = 0;
+}
+
+result_t scheduler_add_session(world_session_t *session) {
+    map_updater_t *m = scheduler_find_map(session->player.map);
+    if (!m) return ERR_NOT_FOUND;
+
+    result_t result = OK;
+
+    mutex_lock(&m->lock);
+    if (m->count >= m->capacity) {
+        int new_capacity = m->capacity == 0 ? 16 : m->capacity * 2;
+        world_session_t **new_sessions = (world_session_t**)realloc(
+            m->sessions, new_capacity * sizeof(world_session_t*));
+        if (!new_sessions) {
+            result = ERR_MEMORY;
+        } else {
+            m->sessions = new_sessions;
+            m->capacity = new_capacity;
+        }
+    }
+    if (result == OK) {
+        m->sessions[m->count++] = session;
+        world_session_enter_map(session);
+    }
+    mutex_unlock(&m->lock);
+
+    return result;
+}
+
+void scheduler_remove_session(world_session_t *session) {
+    map_updater_t *m = scheduler_find_map(session->player.map);
+    if (!m) {
+        grid_remove(&session->player.grid);
+        return;
+    }
+
+    /* Grid removal happens under the map lock, so a map thread can rely on
+     * every session it finds in its grid staying alive for the whole tick */
+    mutex_lock(&m->lock);
+    for (int i = 0; i < m->count; i++) {
+        if (m->sessions[i] == session) {
+            map_remove_at(m, i);
+            break;
+        }
+    }
+    world_session_leave_map(session);
+    mutex_unlock(&m->lock);
+}
+
+int scheduler_map_count(void) {
+    return g_map_count;
+}
+
+result_t scheduler_get_stats(int index, map_tick_stats_t *stats) {
+    if (index < 0 || index >= g_map_count) return ERR_NOT_FOUND;
+
+    mutex_lock(&g_maps[index].lock);
+    *stats = g_maps[index].stats;
+    mutex_unlock(&g_maps[index].lock);
+    return OK;
+}
@@ -9,29 +9,20 @@
 #include "opcodes.h"
 
 void update_builder_init(update_builder_t *builder) {
-    memset(builder->fields, 0, sizeof(builder->fields));
-    memset(builder->field_set, 0, sizeof(builder->field_set));
+    memset(builder->mask, 0, sizeof(builder->mask));
     builder->max_field = -1;
 }
 
 void update_set_guid(update_builder_t *builder, int field, uint64_t value) {
-    if (field < 0 || field + 1 >= MAX_UPDATE_FIELDS) return;
-
-    builder->fields[field] = (uint32_t)(value & 0xFFFFFFFF);
-    builder->fields[field + 1] = (uint32_t)(value >> 32);
-    builder->field_set[field] = true;
-    builder->field_set[field + 1] = true;
-
-    if (field + 1 > builder->max_field) {
-        builder->max_field = field + 1;
-    }
+    update_set_uint32(builder, field, (uint32_t)(value & 0xFFFFFFFF));
+    update_set_uint32(builder, field + 1, (uint32_t)(value >> 32));
 }
 
 void update_set_uint32(update_builder_t *builder, int field, uint32_t value) {
     if (field < 0 || field >= MAX_UPDATE_FIELDS) return;
 
     builder->fields[field] = value;
-    builder->field_set[field] = true;
+    builder->mask[field / 64] |= 1ull << (field % 64);
 
     if (field > builder->max_field) {
         builder->max_field = field;
@@ -52,13 +43,11 @@ void update_set_byte(update_builder_t *builder, int field, int byte_index, uint8
     if (field < 0 || field >= MAX_UPDATE_FIELDS) return;
     if (byte_index < 0 || byte_index > 3) return;
 
-    uint32_t mask = (uint32_t)(0xFF << (byte_index * 8));
-    builder->fields[field] = (builder->fields[field] & ~mask) | ((uint32_t)value << (byte_index * 8));
-    builder->field_set[field] = true;
-
-    if (field > builder->max_field) {
-        builder->max_field = field;
-    }
+    /* Unset fields hold stale data, treat them as zero */
+    bool set = (builder->mask[field / 64] >> (field % 64)) & 1;
+    uint32_t current = set ? builder->fields[field] : 0;
+    uint32_t mask = 0xFFu << (byte_index * 8);
+    update_set_uint32(builder, field, (current & ~mask) | ((uint32_t)value << (byte_index * 8)));
 }
 
 /* Write movement block for UPDATEFLAG_LIVING (TBC format) */
@@ -88,166 +77,197 @@ static void write_movement_block(packet_writer_t *packet, const player_t *player
     write_float(packet, 3.141593f);  /* Turn rate */
 }
 
-/* Write update mask and field values */
-static void write_update_fields(packet_writer_t *packet, const update_builder_t *builder) {
-    int max_field = builder->max_field + 1;
-    int mask_blocks = (max_field + 31) / 32;
-
-    /* Write block count */
-    write_uint8(packet, (uint8_t)mask_blocks);
-
-    /* Build and write mask */
-    uint32_t *mask = (uint32_t*)calloc(mask_blocks, sizeof(uint32_t));
-    for (int i = 0; i <= builder->max_field; i++) {
-        if (builder->field_set[i]) {
-            mask[i / 32] |= (1u << (i % 32));
-        }
+/* Write mask_blocks 32-bit mask blocks followed by the values they select.
+ * The size is known up front from popcounts, so the whole thing goes into
+ * one reserved span and set bits are walked a 64-bit word at a time. */
+static result_t write_masked_values(packet_writer_t *packet, const uint64_t *mask,
+                                    int mask_blocks, const uint32_t *values) {
+    int words = (mask_blocks + 1) / 2;
+    uint64_t last_word_mask = (mask_blocks & 1) ? 0xFFFFFFFFull : ~0ull;
+
+    int value_count = 0;
+    for (int w = 0; w < words; w++) {
+        uint64_t bits = w == words - 1 ? mask[w] & last_word_mask : mask[w];
+        value_count += bit_count64(bits);
     }
 
+    uint8_t *out = writer_reserve(packet, 1 + (size_t)mask_blocks * 4 + (size_t)value_count * 4);
+    if (!out) return ERR_BUFFER_OVERFLOW;
+
+    *out++ = (uint8_t)mask_blocks;
     for (int i = 0; i < mask_blocks; i++) {
-        write_uint32(packet, mask[i]);
+        store_le32(out, (uint32_t)(mask[i / 2] >> ((i & 1) * 32)));
+        out += 4;
     }
 
-    /* Write field values in order */
-    for (int i = 0; i < max_field; i++) {
-        if (builder->field_set[i]) {
-            write_uint32(packet, builder->fields[i]);
+    for (int w = 0; w < words; w++) {
+        uint64_t bits = w == words - 1 ? mask[w] & last_word_mask : mask[w];
+        while (bits) {
+            store_le32(out, values[w * 64 + bit_lowest64(bits)]);
+            out += 4;
+            bits &= bits - 1;
         }
     }
 
-    free(mask);
+    return OK;
 }
 
-result_t update_build_create_packet(update_builder_t *builder,
-                                            const player_t *player,
-                                            bool self,
-                                            packet_writer_t *packet) {
-    /* Set all required fields */
-    update_set_guid(builder, UF_OBJECT_FIELD_GUID, player->guid);
-    update_set_uint32(builder, UF_OBJECT_FIELD_TYPE, TYPE_OBJECT | TYPE_UNIT | TYPE_PLAYER);
-    update_set_float(builder, UF_OBJECT_FIELD_SCALE_X, 1.0f);
+result_t update_write_fields(packet_writer_t *packet, const update_builder_t *builder) {
+    int mask_blocks = (builder->max_field + 32) / 32;
+    return write_masked_values(packet, builder->mask, mask_blocks, builder->fields);
+}
+
+void update_init_player_fields(player_t *player) {
+    field_store_t *fields = &player->fields;
+    field_store_init(fields);
+
+    /* Object fields */
+    field_store_set_guid(fields, UF_OBJECT_FIELD_GUID, player->guid);
+    field_store_set_uint32(fields, UF_OBJECT_FIELD_TYPE, TYPE_OBJECT | TYPE_UNIT | TYPE_PLAYER);
+    field_store_set_float(fields, UF_OBJECT_FIELD_SCALE_X, 1.0f);
 
     /* Unit fields */
-    update_set_int32(builder, UF_UNIT_FIELD_HEALTH, player_get_health(player));
-    update_set_int32(builder, UF_UNIT_FIELD_MAXHEALTH, player_get_max_health(player));
-    update_set_int32(builder, UF_UNIT_FIELD_POWER1, player_get_power(player));
-    update_set_int32(builder, UF_UNIT_FIELD_MAXPOWER1, player_get_max_power(player));
-    update_set_int32(builder, UF_UNIT_FIELD_LEVEL, player->character.level);
-    update_set_int32(builder, UF_UNIT_FIELD_FACTIONTEMPLATE, player_get_faction_template(player));
+    field_store_set_int32(fields, UF_UNIT_FIELD_HEALTH, player_get_health(player));
+    field_store_set_int32(fields, UF_UNIT_FIELD_MAXHEALTH, player_get_max_health(player));
+    field_store_set_int32(fields, UF_UNIT_FIELD_POWER1, player_get_power(player));
+    field_store_set_int32(fields, UF_UNIT_FIELD_MAXPOWER1, player_get_max_power(player));
+    field_store_set_int32(fields, UF_UNIT_FIELD_LEVEL, player->character.level);
+    field_store_set_int32(fields, UF_UNIT_FIELD_FACTIONTEMPLATE, player_get_faction_template(player));
 
     /* UNIT_FIELD_BYTES_0: race, class, gender, powertype */
-    update_set_byte(builder, UF_UNIT_FIELD_BYTES_0, 0, player->character.race);
-    update_set_byte(builder, UF_UNIT_FIELD_BYTES_0, 1, player->character.char_class);
-    update_set_byte(builder, UF_UNIT_FIELD_BYTES_0, 2, player->character.gender);
-    update_set_byte(builder, UF_UNIT_FIELD_BYTES_0, 3, player_get_power_type(player));
+    field_store_set_byte(fields, UF_UNIT_FIELD_BYTES_0, 0, player->character.race);
+    field_store_set_byte(fields, UF_UNIT_FIELD_BYTES_0, 1, player->character.char_class);
+    field_store_set_byte(fields, UF_UNIT_FIELD_BYTES_0, 2, player->character.gender);
+    field_store_set_byte(fields, UF_UNIT_FIELD_BYTES_0, 3, player_get_power_type(player));
 
     /* UNIT_FIELD_FLAGS: UNIT_FLAG_PLAYER_CONTROLLED is required for players */
-    update_set_uint32(builder, UF_UNIT_FIELD_FLAGS, 0x00000008);
+    field_store_set_uint32(fields, UF_UNIT_FIELD_FLAGS, 0x00000008);
 
-    update_set_int32(builder, UF_UNIT_FIELD_DISPLAYID, player_get_display_id(player));
-    update_set_int32(builder, UF_UNIT_FIELD_NATIVEDISPLAYID, player_get_display_id(player));
-    update_set_int32(builder, UNIT_FIELD_MOUNTDISPLAYID, 0);
+    field_store_set_int32(fields, UF_UNIT_FIELD_DISPLAYID, player_get_display_id(player));
+    field_store_set_int32(fields, UF_UNIT_FIELD_NATIVEDISPLAYID, player_get_display_id(player));
+    field_store_set_int32(fields, UNIT_FIELD_MOUNTDISPLAYID, 0);
 
-    update_set_float(builder, UF_UNIT_FIELD_BOUNDINGRADIUS, 0.389f);
-    update_set_float(builder, UF_UNIT_FIELD_COMBATREACH, 1.5f);
+    field_store_set_float(fields, UF_UNIT_FIELD_BOUNDINGRADIUS, 0.389f);
+    field_store_set_float(fields, UF_UNIT_FIELD_COMBATREACH, 1.5f);
 
-    update_set_float(builder, UF_UNIT_FIELD_MINDAMAGE, 1.0f);
-    update_set_float(builder, UF_UNIT_FIELD_MAXDAMAGE, 2.0f);
-    update_set_float(builder, UNIT_FIELD_MINOFFHANDDAMAGE, 0.0f);
-    update_set_float(builder, UNIT_FIELD_MAXOFFHANDDAMAGE, 0.0f);
-    update_set_uint32(builder, UF_UNIT_FIELD_BASEATTACKTIME, 2000);
-    update_set_uint32(builder, UF_UNIT_FIELD_BASEATTACKTIME + 1, 2000);
-    update_set_uint32(builder, UNIT_FIELD_RANGEDATTACKTIME, 0);
+    field_store_set_float(fields, UF_UNIT_FIELD_MINDAMAGE, 1.0f);
+    field_store_set_float(fields, UF_UNIT_FIELD_MAXDAMAGE, 2.0f);
+    field_store_set_float(fields, UNIT_FIELD_MINOFFHANDDAMAGE, 0.0f);
+    field_store_set_float(fields, UNIT_FIELD_MAXOFFHANDDAMAGE, 0.0f);
+    field_store_set_uint32(fields, UF_UNIT_FIELD_BASEATTACKTIME, 2000);
+    field_store_set_uint32(fields, UF_UNIT_FIELD_BASEATTACKTIME + 1, 2000);
+    field_store_set_uint32(fields, UNIT_FIELD_RANGEDATTACKTIME, 0);
 
-    update_set_float(builder, UF_UNIT_MOD_CAST_SPEED, 1.0f);
+    field_store_set_float(fields, UF_UNIT_MOD_CAST_SPEED, 1.0f);
 
     /* Base stats */
-    update_set_int32(builder, UF_UNIT_FIELD_STAT0, 20);  /* Strength */
-    update_set_int32(builder, UF_UNIT_FIELD_STAT1, 20);  /* Agility */
-    update_set_int32(builder, UF_UNIT_FIELD_STAT2, 20);  /* Stamina */
-    update_set_int32(builder, UF_UNIT_FIELD_STAT3, 20);  /* Intellect */
-    update_set_int32(builder, UF_UNIT_FIELD_STAT4, 20);  /* Spirit */
+    field_store_set_int32(fields, UF_UNIT_FIELD_STAT0, 20);  /* Strength */
+    field_store_set_int32(fields, UF_UNIT_FIELD_STAT1, 20);  /* Agility */
+    field_store_set_int32(fields, UF_UNIT_FIELD_STAT2, 20);  /* Stamina */
+    field_store_set_int32(fields, UF_UNIT_FIELD_STAT3, 20);  /* Intellect */
+    field_store_set_int32(fields, UF_UNIT_FIELD_STAT4, 20);  /* Spirit */
 
     /* Resistances (7 fields: armor + 6 magic schools) */
-    update_set_int32(builder, UNIT_FIELD_RESISTANCES, 0);       /* Armor */
-    update_set_int32(builder, UNIT_FIELD_RESISTANCES + 1, 0);   /* Holy */
-    update_set_int32(builder, UNIT_FIELD_RESISTANCES + 2, 0);   /* Fire */
-    update_set_int32(builder, UNIT_FIELD_RESISTANCES + 3, 0);   /* Nature */
-    update_set_int32(builder, UNIT_FIELD_RESISTANCES + 4, 0);   /* Frost */
-    update_set_int32(builder, UNIT_FIELD_RESISTANCES + 5, 0);   /* Shadow */
-    update_set_int32(builder, UNIT_FIELD_RESISTANCES + 6, 0);   /* Arcane */
+    field_store_set_int32(fields, UNIT_FIELD_RESISTANCES, 0);       /* Armor */
+    field_store_set_int32(fields, UNIT_FIELD_RESISTANCES + 1, 0);   /* Holy */
+    field_store_set_int32(fields, UNIT_FIELD_RESISTANCES + 2, 0);   /* Fire */
+    field_store_set_int32(fields, UNIT_FIELD_RESISTANCES + 3, 0);   /* Nature */
+    field_store_set_int32(fields, UNIT_FIELD_RESISTANCES + 4, 0);   /* Frost */
+    field_store_set_int32(fields, UNIT_FIELD_RESISTANCES + 5, 0);   /* Shadow */
+    field_store_set_int32(fields, UNIT_FIELD_RESISTANCES + 6, 0);   /* Arcane */
 
-    update_set_int32(builder, UF_UNIT_FIELD_BASE_HEALTH, player_get_max_health(player));
-    update_set_int32(builder, UF_UNIT_FIELD_BASE_MANA, player_get_max_power(player));
+    field_store_set_int32(fields, UF_UNIT_FIELD_BASE_HEALTH, player_get_max_health(player));
+    field_store_set_int32(fields, UF_UNIT_FIELD_BASE_MANA, player_get_max_power(player));
 
     /* UNIT_FIELD_BYTES_1: standstate (0=standing) */
-    update_set_byte(builder, UF_UNIT_FIELD_BYTES_1, 0, 0);
+    field_store_set_byte(fields, UF_UNIT_FIELD_BYTES_1, 0, 0);
 
     /* UNIT_FIELD_BYTES_2: sheath=0, pvp flags */
-    update_set_byte(builder, UF_UNIT_FIELD_BYTES_2, 0, 0);
-    update_set_byte(builder, UF_UNIT_FIELD_BYTES_2, 1, 0x28);
+    field_store_set_byte(fields, UF_UNIT_FIELD_BYTES_2, 0, 0);
+    field_store_set_byte(fields, UF_UNIT_FIELD_BYTES_2, 1, 0x28);
 
     /* Attack power */
-    update_set_int32(builder, UNIT_FIELD_ATTACK_POWER, 0);
-    update_set_int32(builder, UNIT_FIELD_ATTACK_POWER_MODS, 0);
-    update_set_float(builder, UNIT_FIELD_ATTACK_POWER_MULTIPLIER, 1.0f);
-    update_set_int32(builder, UNIT_FIELD_RANGED_ATTACK_POWER, 0);
-    update_set_int32(builder, UNIT_FIELD_RANGED_ATTACK_POWER_MODS, 0);
-    update_set_float(builder, UNIT_FIELD_RANGED_ATTACK_POWER_MULT, 1.0f);
-    update_set_float(builder, UNIT_FIELD_MINRANGEDDAMAGE, 0.0f);
-    update_set_float(builder, UNIT_FIELD_MAXRANGEDDAMAGE, 0.0f);
+    field_store_set_int32(fields, UNIT_FIELD_ATTACK_POWER, 0);
+    field_store_set_int32(fields, UNIT_FIELD_ATTACK_POWER_MODS, 0);
+    field_store_set_float(fields, UNIT_FIELD_ATTACK_POWER_MULTIPLIER, 1.0f);
+    field_store_set_int32(fields, UNIT_FIELD_RANGED_ATTACK_POWER, 0);
+    field_store_set_int32(fields, UNIT_FIELD_RANGED_ATTACK_POWER_MODS, 0);
+    field_store_set_float(fields, UNIT_FIELD_RANGED_ATTACK_POWER_MULT, 1.0f);
+    field_store_set_float(fields, UNIT_FIELD_MINRANGEDDAMAGE, 0.0f);
+    field_store_set_float(fields, UNIT_FIELD_MAXRANGEDDAMAGE, 0.0f);
 
     /* Player fields */
-    update_set_uint32(builder, UF_PLAYER_FLAGS, 0);
+    field_store_set_uint32(fields, UF_PLAYER_FLAGS, 0);
 
     /* PLAYER_BYTES: skin, face, hairstyle, haircolor */
-    update_set_byte(builder, UF_PLAYER_BYTES, 0, player->character.skin);
-    update_set_byte(builder, UF_PLAYER_BYTES, 1, player->character.face);
-    update_set_byte(builder, UF_PLAYER_BYTES, 2, player->character.hair_style);
-    update_set_byte(builder, UF_PLAYER_BYTES, 3, player->character.hair_color);
+    field_store_set_byte(fields, UF_PLAYER_BYTES, 0, player->character.skin);
+    field_store_set_byte(fields, UF_PLAYER_BYTES, 1, player->character.face);
+    field_store_set_byte(fields, UF_PLAYER_BYTES, 2, player->character.hair_style);
+    field_store_set_byte(fields, UF_PLAYER_BYTES, 3, player->character.hair_color);
 
     /* PLAYER_BYTES_2: facial hair */
-    update_set_byte(builder, UF_PLAYER_BYTES_2, 0, player->character.facial_hair);
+    field_store_set_byte(fields, UF_PLAYER_BYTES_2, 0, player->character.facial_hair);
 
     /* PLAYER_BYTES_3: gender */
-    update_set_byte(builder, UF_PLAYER_BYTES_3, 0, player->character.gender);
+    field_store_set_byte(fields, UF_PLAYER_BYTES_3, 0, player->character.gender);
 
     /* XP */
-    update_set_uint32(builder, PLAYER_XP, 0);
-    update_set_uint32(builder, PLAYER_NEXT_LEVEL_XP, 400);
+    field_store_set_uint32(fields, PLAYER_XP, 0);
+    field_store_set_uint32(fields, PLAYER_NEXT_LEVEL_XP, 400);
 
     /* Character points */
-    update_set_uint32(builder, PLAYER_CHARACTER_POINTS1, 0);  /* Talent points */
-    update_set_uint32(builder, PLAYER_CHARACTER_POINTS2, 2);  /* Profession slots */
+    field_store_set_uint32(fields, PLAYER_CHARACTER_POINTS1, 0);  /* Talent points */
+    field_store_set_uint32(fields, PLAYER_CHARACTER_POINTS2, 2);  /* Profession slots */
 
     /* Combat percentages */
-    update_set_float(builder, PLAYER_BLOCK_PERCENTAGE, 0.0f);
-    update_set_float(builder, PLAYER_DODGE_PERCENTAGE, 0.0f);
-    update_set_float(builder, PLAYER_PARRY_PERCENTAGE, 0.0f);
-    update_set_float(builder, PLAYER_CRIT_PERCENTAGE, 0.0f);
-    update_set_float(builder, PLAYER_RANGED_CRIT_PERCENTAGE, 0.0f);
+    field_store_set_float(fields, PLAYER_BLOCK_PERCENTAGE, 0.0f);
+    field_store_set_float(fields, PLAYER_DODGE_PERCENTAGE, 0.0f);
+    field_store_set_float(fields, PLAYER_PARRY_PERCENTAGE, 0.0f);
+    field_store_set_float(fields, PLAYER_CRIT_PERCENTAGE, 0.0f);
+    field_store_set_float(fields, PLAYER_RANGED_CRIT_PERCENTAGE, 0.0f);
 
     /* Rest and money */
-    update_set_uint32(builder, PLAYER_REST_STATE_EXPERIENCE, 0);
-    update_set_uint32(builder, PLAYER_FIELD_COINAGE, 0);
+    field_store_set_uint32(fields, PLAYER_REST_STATE_EXPERIENCE, 0);
+    field_store_set_uint32(fields, PLAYER_FIELD_COINAGE, 0);
 
     /* Mod damage done (7 schools) */
     for (int i = 0; i < 7; i++) {
-        update_set_float(builder, PLAYER_FIELD_MOD_DAMAGE_DONE_PCT + i, 1.0f);
+        field_store_set_float(fields, PLAYER_FIELD_MOD_DAMAGE_DONE_PCT + i, 1.0f);
     }
 
     /* Watched faction (-1 = none) */
-    update_set_int32(builder, PLAYER_FIELD_WATCHED_FACTION_INDEX, -1);
+    field_store_set_int32(fields, PLAYER_FIELD_WATCHED_FACTION_INDEX, -1);
 
     /* Max level (TBC) */
-    update_set_uint32(builder, PLAYER_FIELD_MAX_LEVEL, 70);
+    field_store_set_uint32(fields, PLAYER_FIELD_MAX_LEVEL, 70);
 
-    /* Build the packet */
+    /* Nothing is pending until something changes after login */
+    field_store_mark_baseline(fields);
+    player->template_key = UPDATE_TEMPLATE_KEY(player->character.race, player->character.char_class,
+                                               player->character.gender, player->character.level);
+}
 
-    /* Block count */
-    write_uint32(packet, 1);  /* 1 update block */
-    write_uint8(packet, 0);   /* hasTransport (TBC addition) */
+void update_builder_load(update_builder_t *builder, const field_store_t *fields) {
+    for (int w = 0; w < FIELD_MASK_WORDS; w++) {
+        uint64_t bits = fields->set_mask[w];
+        builder->mask[w] |= bits;
+        while (bits) {
+            int field = w * 64 + bit_lowest64(bits);
+            builder->fields[field] = fields->values[field];
+            if (field > builder->max_field) {
+                builder->max_field = field;
+            }
+            bits &= bits - 1;
+        }
+    }
+}
 
+result_t update_write_packet_header(packet_writer_t *packet, uint32_t block_count) {
+    write_uint32(packet, block_count);
+    return write_uint8(packet, 0);  /* hasTransport (TBC addition) */
+}
+
+result_t update_write_create_header(packet_writer_t *packet, const player_t *player, bool self) {
     /* Update type: CREATE_OBJECT2 for players */
     write_uint8(packet, UPDATETYPE_CREATE_OBJECT2);
 
@@ -270,10 +290,70 @@ result_t update_build_create_packet(update_builder_t *builder,
     write_movement_block(packet, player);
 
     /* UPDATEFLAG_HIGHGUID: write high part of GUID after movement block */
-    write_uint32(packet, 0);  /* HIGHGUID_PLAYER = 0x0000 */
+    return write_uint32(packet, 0);  /* HIGHGUID_PLAYER = 0x0000 */
+}
+
+result_t update_write_create_block(update_builder_t *builder, const player_t *player,
+                                   bool self, packet_writer_t *packet) {
+    /* Current values of every field the object has */
+    update_builder_load(builder, &player->fields);
+
+    update_write_create_header(packet, player, self);
 
     /* Update mask and values */
-    write_update_fields(packet, builder);
+    return update_write_fields(packet, builder);
+}
+
+result_t update_write_values_block(const player_t *player, packet_writer_t *packet) {
+    const field_store_t *fields = &player->fields;
+    if (!fields->dirty) return ERR_NOT_FOUND;
+
+    /* Mask only needs to reach the last changed field */
+    int last = FIELD_MASK_WORDS - 1;
+    while (last > 0 && fields->dirty_mask[last] == 0) {
+        last--;
+    }
+    int mask_blocks = last * 2 + ((fields->dirty_mask[last] >> 32) ? 2 : 1);
+
+    write_uint8(packet, UPDATETYPE_VALUES);
+    write_packed_guid(packet, player->guid);
+
+    return write_masked_values(packet, fields->dirty_mask, mask_blocks, fields->values);
+}
+
+result_t update_write_out_of_range_block(const uint64_t *guids, int count,
+                                         packet_writer_t *packet) {
+    if (count <= 0) return ERR_INVALID_PARAM;
+
+    write_uint8(packet, UPDATETYPE_OUT_OF_RANGE_OBJECTS);
+
+    write_uint32(packet, (uint32_t)count);
+    for (int i = 0; i < count; i++) {
+        write_packed_guid(packet, guids[i]);
+    }
 
     return OK;
 }
+
+result_t update_build_create_packet(update_builder_t *builder,
+                                            const player_t *player,
+                                            bool self,
+                                            packet_writer_t *packet) {
+    update_write_packet_header(packet, 1);
+    return update_write_create_block(builder, player, self, packet);
+}
+
+result_t update_build_values_packet(const player_t *player, packet_writer_t *packet) {
+    if (!player->fields.dirty) return ERR_NOT_FOUND;
+
+    update_write_packet_header(packet, 1);
+    return update_write_values_block(player, packet);
+}
+
+result_t update_build_out_of_range_packet(const uint64_t *guids, int count,
+                                          packet_writer_t *packet) {
+    if (count <= 0) return ERR_INVALID_PARAM;
+
+    update_write_packet_header(packet, 1);
+    return update_write_out_of_range_block(guids, count, packet);
+}
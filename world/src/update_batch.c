@@ -0,0 +1,115 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * update_batch.c - Per-observer accumulation of update blocks
+ *
+ * Blocks are written straight after each other into one buffer that starts
+ * with the SMSG_UPDATE_OBJECT prefix. A flush patches the block count and
+ * hands the body on, so dozens of objects share one header, one compression
+ * pass and one send. A block that would push the body past the size limit
+ * seals what came before it into its own packet and starts the next one.
+ */
+
+#include "update_batch.h"
+#include "update.h"
+#include "update_template.h"
+#include "thread.h"
+
+/* Block count (u32) + hasTransport (u8) */
+#define BATCH_HEADER_SIZE 5
+
+static update_batch_stats_t g_batch_stats;
+
+result_t update_batch_init(update_batch_t *batch, update_batch_sink_t sink, void *sink_ctx) {
+    batch->block_count = 0;
+    batch->sink = sink;
+    batch->sink_ctx = sink_ctx;
+    return writer_init(&batch->packet);
+}
+
+void update_batch_free(update_batch_t *batch) {
+    writer_free(&batch->packet);
+    batch->block_count = 0;
+}
+
+void update_batch_reset(update_batch_t *batch) {
+    writer_reset(&batch->packet);
+    batch->block_count = 0;
+}
+
+/* Hand the first `size` bytes of the buffer to the sink as a packet */
+static result_t batch_emit(update_batch_t *batch, size_t size, uint32_t block_count) {
+    store_le32(batch->packet.data, block_count);
+
+    atomic_add_uint64(&g_batch_stats.packets, 1);
+    atomic_add_uint64(&g_batch_stats.blocks, block_count);
+    return batch->sink(batch->sink_ctx, batch->packet.data, size);
+}
+
+/* Offset the next block starts at, writing the prefix for an empty batch */
+static size_t batch_begin(update_batch_t *batch) {
+    if (writer_size(&batch->packet) == 0) {
+        update_write_packet_header(&batch->packet, 0);
+    }
+    return writer_size(&batch->packet);
+}
+
+/* Account for the block written at start, splitting if it overflowed */
+static result_t batch_commit(update_batch_t *batch, size_t start, result_t result) {
+    if (result != OK) {
+        batch->packet.size = start;
+        return result;
+    }
+
+    result_t emit = OK;
+    size_t end = writer_size(&batch->packet);
+    if (end > UPDATE_BATCH_MAX_SIZE && batch->block_count > 0) {
+        emit = batch_emit(batch, start, batch->block_count);
+        atomic_add_uint64(&g_batch_stats.splits, 1);
+
+        /* The new block opens the next packet */
+        memmove(batch->packet.data + BATCH_HEADER_SIZE, batch->packet.data + start, end - start);
+        batch->packet.size = BATCH_HEADER_SIZE + (end - start);
+        batch->block_count = 0;
+    }
+
+    batch->block_count++;
+    return emit;
+}
+
+result_t update_batch_add_create(update_batch_t *batch, const player_t *player, bool self) {
+    size_t start = batch_begin(batch);
+    return batch_commit(batch, start, update_template_write_create(player, self, &batch->packet));
+}
+
+result_t update_batch_add_values(update_batch_t *batch, const player_t *player) {
+    if (!player->fields.dirty) return ERR_NOT_FOUND;
+
+    size_t start = batch_begin(batch);
+    return batch_commit(batch, start, update_write_values_block(player, &batch->packet));
+}
+
+result_t update_batch_add_out_of_range(update_batch_t *batch, const uint64_t *guids, int count) {
+    if (count <= 0) return ERR_INVALID_PARAM;
+
+    size_t start = batch_begin(batch);
+    return batch_commit(batch, start, update_write_out_of_range_block(guids, count, &batch->packet));
+}
+
+result_t update_batch_add_block(update_batch_t *batch, const uint8_t *data, size_t size) {
+    size_t start = batch_begin(batch);
+    return batch_commit(batch, start, write_bytes(&batch->packet, data, size));
+}
+
+result_t update_batch_flush(update_batch_t *batch) {
+    if (batch->block_count == 0) return OK;
+
+    result_t result = batch_emit(batch, writer_size(&batch->packet), batch->block_count);
+    update_batch_reset(batch);
+    return result;
+}
+
+void update_batch_get_stats(update_batch_stats_t *stats) {
+    *stats = g_batch_stats;
+}
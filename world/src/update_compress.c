@@ -0,0 +1,140 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * update_compress.c - SMSG_COMPRESSED_UPDATE_OBJECT encoding
+ *
+ * Each thread keeps its own deflate stream and output buffer, reset rather
+ * than re-initialized between packets, so the ~256 KB zlib state is set up
+ * once per thread instead of once per packet. Without zlib (ASHEMU_WITH_ZLIB
+ * undefined) every packet is sent uncompressed.
+ */
+
+#include "update_compress.h"
+#include "thread.h"
+
+#ifdef ASHEMU_WITH_ZLIB
+#include <zlib.h>
+#endif
+
+#define DEFAULT_COMPRESS_CONFIG \
+    { true, UPDATE_COMPRESS_DEFAULT_THRESHOLD, UPDATE_COMPRESS_DEFAULT_LEVEL }
+
+static update_compress_config_t g_compress_config = DEFAULT_COMPRESS_CONFIG;
+static update_compress_stats_t g_compress_stats;
+
+void update_compress_config_default(update_compress_config_t *config) {
+    update_compress_config_t defaults = DEFAULT_COMPRESS_CONFIG;
+    *config = defaults;
+}
+
+result_t update_compress_set_config(const update_compress_config_t *config) {
+    if (config->level < 1 || config->level > 9) return ERR_INVALID_PARAM;
+    g_compress_config = *config;
+    return OK;
+}
+
+void update_compress_get_stats(update_compress_stats_t *stats) {
+    *stats = g_compress_stats;
+}
+
+#ifdef ASHEMU_WITH_ZLIB
+
+/* Per-thread deflate state */
+typedef struct {
+    z_stream stream;
+    bool initialized;
+    int level;
+    uint8_t *buffer;
+    size_t capacity;
+} deflate_ctx_t;
+
+static THREAD_LOCAL deflate_ctx_t t_deflate;
+
+static bool deflate_ctx_prepare(deflate_ctx_t *ctx, int level, size_t size) {
+    /* The level is fixed at init; re-create the stream if it was tuned */
+    if (ctx->initialized && ctx->level != level) {
+        deflateEnd(&ctx->stream);
+        ctx->initialized = false;
+    }
+
+    if (!ctx->initialized) {
+        memset(&ctx->stream, 0, sizeof(ctx->stream));
+        if (deflateInit(&ctx->stream, level) != Z_OK) return false;
+        ctx->initialized = true;
+        ctx->level = level;
+    } else if (deflateReset(&ctx->stream) != Z_OK) {
+        return false;
+    }
+
+    size_t bound = deflateBound(&ctx->stream, (uLong)size);
+    if (bound > ctx->capacity) {
+        uint8_t *buffer = (uint8_t*)realloc(ctx->buffer, bound);
+        if (!buffer) return false;
+        ctx->buffer = buffer;
+        ctx->capacity = bound;
+    }
+    return true;
+}
+
+bool update_compress(const uint8_t *data, size_t size, packet_writer_t *out) {
+    update_compress_config_t config = g_compress_config;
+    if (!config.enabled || size < config.threshold) return false;
+
+    deflate_ctx_t *ctx = &t_deflate;
+    uint64_t start = get_time_us();
+
+    if (!deflate_ctx_prepare(ctx, config.level, size)) return false;
+
+    ctx->stream.next_in = (Bytef*)data;
+    ctx->stream.avail_in = (uInt)size;
+    ctx->stream.next_out = ctx->buffer;
+    ctx->stream.avail_out = (uInt)ctx->capacity;
+
+    int status = deflate(&ctx->stream, Z_FINISH);
+    size_t compressed = ctx->capacity - ctx->stream.avail_out;
+
+    atomic_add_uint64(&g_compress_stats.compress_us, get_time_us() - start);
+
+    if (status != Z_STREAM_END || compressed + 4 >= size) {
+        atomic_add_uint64(&g_compress_stats.packets_skipped, 1);
+        return false;
+    }
+
+    size_t out_start = out->size;
+    if (write_uint32(out, (uint32_t)size) != OK || write_bytes(out, ctx->buffer, compressed) != OK) {
+        /* Send it uncompressed rather than truncated */
+        out->size = out_start;
+        atomic_add_uint64(&g_compress_stats.packets_skipped, 1);
+        return false;
+    }
+
+    atomic_add_uint64(&g_compress_stats.packets_compressed, 1);
+    atomic_add_uint64(&g_compress_stats.bytes_in, size);
+    atomic_add_uint64(&g_compress_stats.bytes_out, compressed + 4);
+    return true;
+}
+
+void update_compress_thread_cleanup(void) {
+    deflate_ctx_t *ctx = &t_deflate;
+    if (ctx->initialized) {
+        deflateEnd(&ctx->stream);
+        ctx->initialized = false;
+    }
+    FREE(ctx->buffer);
+    ctx->capacity = 0;
+}
+
+#else
+
+bool update_compress(const uint8_t *data, size_t size, packet_writer_t *out) {
+    (void)data;
+    (void)size;
+    (void)out;
+    return false;
+}
+
+void update_compress_thread_cleanup(void) {
+}
+
+#endif /* ASHEMU_WITH_ZLIB */
@@ -0,0 +1,198 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * update_template.c - Cached create blocks per race/class/gender/level
+ *
+ * Almost every field of a freshly logged in player is a function of race,
+ * class, gender and level. The update mask and values for each such
+ * combination are serialized once, together with the byte offset of every
+ * field inside them. A create block is then the header and movement block,
+ * a memcpy of the template, and a store for each field that is per-player
+ * (GUID, appearance) or has changed since login.
+ */
+
+#include "update_template.h"
+#include "update.h"
+#include "thread.h"
+
+/* Hash buckets (race/class/gender/level combinations actually in use) */
+#define TEMPLATE_BUCKETS 256
+
+/* Serialized update fields for one key */
+typedef struct update_template {
+    struct update_template *next;
+    uint32_t key;
+    uint64_t mask[FIELD_MASK_WORDS];    /* Fields present in the block */
+    int16_t offsets[FIELD_STORE_SIZE];  /* Byte offset of each field's value in data */
+    size_t size;
+    uint8_t data[];                     /* Mask blocks followed by values */
+} update_template_t;
+
+static update_template_t *g_templates[TEMPLATE_BUCKETS];
+static mutex_t g_templates_lock;
+static update_template_stats_t g_template_stats;
+
+/* Fields that differ between players sharing a template */
+static uint64_t g_player_fields[FIELD_MASK_WORDS];
+
+static void mask_add(uint64_t *mask, int field) {
+    mask[field / 64] |= 1ull << (field % 64);
+}
+
+void update_template_init(void) {
+    mutex_init(&g_templates_lock);
+    memset(g_templates, 0, sizeof(g_templates));
+    memset(&g_template_stats, 0, sizeof(g_template_stats));
+
+    memset(g_player_fields, 0, sizeof(g_player_fields));
+    mask_add(g_player_fields, OBJECT_FIELD_GUID);
+    mask_add(g_player_fields, OBJECT_FIELD_GUID + 1);
+    mask_add(g_player_fields, PLAYER_BYTES);
+    mask_add(g_player_fields, PLAYER_BYTES_2);
+}
+
+void update_template_shutdown(void) {
+    for (int i = 0; i < TEMPLATE_BUCKETS; i++) {
+        update_template_t *tpl = g_templates[i];
+        while (tpl) {
+            update_template_t *next = tpl->next;
+            free(tpl);
+            tpl = next;
+        }
+        g_templates[i] = NULL;
+    }
+    mutex_destroy(&g_templates_lock);
+}
+
+void update_template_get_stats(update_template_stats_t *stats) {
+    *stats = g_template_stats;
+}
+
+/* Serialize the login fields of a stand-in player with the key's attributes */
+static update_template_t *template_build(uint32_t key) {
+    character_t character;
+    character_init(&character);
+    character.race = (uint8_t)(key >> 24);
+    character.char_class = (uint8_t)(key >> 16);
+    character.gender = (uint8_t)(key >> 8);
+    character.level = (uint8_t)key;
+
+    player_t *player = ALLOC(player_t);
+    update_builder_t *builder = ALLOC(update_builder_t);
+    packet_writer_t packet;
+    update_template_t *tpl = NULL;
+
+    if (player && builder && writer_init(&packet) == OK) {
+        player_init(player, &character);
+        update_builder_init(builder);
+        update_builder_load(builder, &player->fields);
+
+        if (update_write_fields(&packet, builder) == OK) {
+            size_t size = writer_size(&packet);
+            tpl = (update_template_t*)malloc(sizeof(update_template_t) + size);
+        }
+
+        if (tpl) {
+            tpl->next = NULL;
+            tpl->key = key;
+            memcpy(tpl->mask, player->fields.set_mask, sizeof(tpl->mask));
+            tpl->size = writer_size(&packet);
+            memcpy(tpl->data, writer_data(&packet), tpl->size);
+
+            /* Values follow the block count and mask, in field order */
+            memset(tpl->offsets, 0xFF, sizeof(tpl->offsets));
+            int offset = 1 + tpl->data[0] * 4;
+            for (int w = 0; w < FIELD_MASK_WORDS; w++) {
+                uint64_t bits = tpl->mask[w];
+                while (bits) {
+                    tpl->offsets[w * 64 + bit_lowest64(bits)] = (int16_t)offset;
+                    offset += 4;
+                    bits &= bits - 1;
+                }
+            }
+        }
+
+        writer_free(&packet);
+    }
+
+    free(builder);
+    free(player);
+    return tpl;
+}
+
+/* Find the template for a key, building it on first use */
+static const update_template_t *template_get(uint32_t key) {
+    uint32_t bucket = (key * 2654435761u) % TEMPLATE_BUCKETS;
+
+    mutex_lock(&g_templates_lock);
+
+    update_template_t *tpl = g_templates[bucket];
+    while (tpl && tpl->key != key) {
+        tpl = tpl->next;
+    }
+
+    if (!tpl) {
+        tpl = template_build(key);
+        if (tpl) {
+            tpl->next = g_templates[bucket];
+            g_templates[bucket] = tpl;
+            atomic_add_uint64(&g_template_stats.built, 1);
+        }
+    }
+
+    mutex_unlock(&g_templates_lock);
+    return tpl;
+}
+
+/* Write the create block field by field */
+static result_t build_create_fallback(const player_t *player, bool self, packet_writer_t *packet) {
+    update_builder_t *builder = ALLOC(update_builder_t);
+    if (!builder) return ERR_MEMORY;
+
+    update_builder_init(builder);
+    result_t result = update_write_create_block(builder, player, self, packet);
+    free(builder);
+
+    atomic_add_uint64(&g_template_stats.fallbacks, 1);
+    return result;
+}
+
+result_t update_template_write_create(const player_t *player, bool self, packet_writer_t *packet) {
+    const field_store_t *fields = &player->fields;
+    const update_template_t *tpl = template_get(player->template_key);
+    if (!tpl) return build_create_fallback(player, self, packet);
+
+    /* Fields to patch; a changed field the template lacks means it cannot be used */
+    uint64_t patch[FIELD_MASK_WORDS];
+    for (int w = 0; w < FIELD_MASK_WORDS; w++) {
+        patch[w] = fields->modified_mask[w] | g_player_fields[w];
+        if (patch[w] & ~tpl->mask[w]) {
+            return build_create_fallback(player, self, packet);
+        }
+    }
+
+    result_t result = update_write_create_header(packet, player, self);
+    if (result != OK) return result;
+
+    uint8_t *out = writer_reserve(packet, tpl->size);
+    if (!out) return ERR_BUFFER_OVERFLOW;
+    memcpy(out, tpl->data, tpl->size);
+
+    for (int w = 0; w < FIELD_MASK_WORDS; w++) {
+        uint64_t bits = patch[w];
+        while (bits) {
+            int field = w * 64 + bit_lowest64(bits);
+            store_le32(out + tpl->offsets[field], fields->values[field]);
+            bits &= bits - 1;
+        }
+    }
+
+    atomic_add_uint64(&g_template_stats.hits, 1);
+    return OK;
+}
+
+result_t update_template_build_create(const player_t *player, bool self, packet_writer_t *packet) {
+    update_write_packet_header(packet, 1);
+    return update_template_write_create(player, self, packet);
+}
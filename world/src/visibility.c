@@ -0,0 +1,128 @@
+/*
+ * AshEmu - WoW 2.4.3 Server Emulator (TBC)
+ * Copyright (C) 2025 AshEmu Team
+ *
+ * visibility.c - Per-session set of visible players
+ *
+ * Each session keeps the GUIDs it has been sent create blocks for, sorted.
+ * Every tick the grid neighbourhood is gathered and sorted the same way, and
+ * a single merge pass yields the objects that came into and went out of
+ * range. Their create and out-of-range blocks go into the session's update
+ * batch and reach the client together at the end of the tick.
+ */
+
+#include "visibility.h"
+#include "grid.h"
+#include "update_batch.h"
+
+/* Object found near the observer this tick */
+typedef struct {
+    uint64_t guid;
+    world_session_t *owner;
+} visible_entry_t;
+
+/* Neighbour collection state */
+typedef struct {
+    const grid_object_t *self;
+    visible_entry_t *entries;
+    int count;
+    int capacity;
+} visibility_ctx_t;
+
+static void collect_visitor(grid_object_t *object, float dist_sq, void *ctx) {
+    (void)dist_sq;
+    visibility_ctx_t *vis = (visibility_ctx_t*)ctx;
+
+    if (object == vis->self || !object->owner) return;
+
+    if (vis->count >= vis->capacity) {
+        int new_capacity = vis->capacity == 0 ? 32 : vis->capacity * 2;
+        visible_entry_t *new_entries = (visible_entry_t*)realloc(
+            vis->entries, new_capacity * sizeof(visible_entry_t));
+        if (!new_entries) return;
+        vis->entries = new_entries;
+        vis->capacity = new_capacity;
+    }
+
+    vis->entries[vis->count].guid = object->guid;
+    vis->entries[vis->count].owner = (world_session_t*)object->owner;
+    vis->count++;
+}
+
+static int compare_entries(const void *a, const void *b) {
+    uint64_t ga = ((const visible_entry_t*)a)->guid;
+    uint64_t gb = ((const visible_entry_t*)b)->guid;
+    return (ga > gb) - (ga < gb);
+}
+
+void visibility_update(world_session_t *session) {
+    grid_object_t *self = &session->player.grid;
+    if (self->map_index < 0) return;
+
+    visibility_ctx_t ctx = { self, NULL, 0, 0 };
+    grid_visit(self->map, self->x, self->y, WORLD_VISIBILITY_DISTANCE, collect_visitor, &ctx);
+    if (ctx.count > 1) {
+        qsort(ctx.entries, ctx.count, sizeof(visible_entry_t), compare_entries);
+    }
+
+    uint64_t *next = ctx.count > 0 ? ALLOC_ARRAY(uint64_t, ctx.count) : NULL;
+    uint64_t *removed = session->visible_count > 0 ? ALLOC_ARRAY(uint64_t, session->visible_count) : NULL;
+    if ((ctx.count > 0 && !next) || (session->visible_count > 0 && !removed)) {
+        free(next);
+        free(removed);
+        free(ctx.entries);
+        return;
+    }
+
+    /* Merge the sorted old and new sets */
+    int removed_count = 0;
+    int i = 0, j = 0;
+    while (i < session->visible_count || j < ctx.count) {
+        if (j >= ctx.count || (i < session->visible_count && session->visible[i] < ctx.entries[j].guid)) {
+            removed[removed_count++] = session->visible[i++];
+        } else if (i >= session->visible_count || ctx.entries[j].guid < session->visible[i]) {
+            update_batch_add_create(&session->update_batch, &ctx.entries[j].owner->player, false);
+            next[j] = ctx.entries[j].guid;
+            j++;
+        } else {
+            next[j] = ctx.entries[j].guid;
+            i++;
+            j++;
+        }
+    }
+
+    if (removed_count > 0) {
+        update_batch_add_out_of_range(&session->update_batch, removed, removed_count);
+    }
+
+    free(session->visible);
+    session->visible = next;
+    session->visible_count = ctx.count;
+
+    free(removed);
+    free(ctx.entries);
+}
+
+bool visibility_contains(const world_session_t *session, uint64_t guid) {
+    int lo = 0, hi = session->visible_count - 1;
+    while (lo <= hi) {
+        int mid = lo + (hi - lo) / 2;
+        uint64_t value = session->visible[mid];
+        if (value == guid) return true;
+        if (value < guid) {
+            lo = mid + 1;
+        } else {
+            hi = mid - 1;
+        }
+    }
+    return false;
+}
+
+void visibility_clear(world_session_t *session) {
+    session->visible_count = 0;
+}
+
+void visibility_free(world_session_t *session) {
+    FREE(session->visible);
+    session->visible_count = 0;
+}
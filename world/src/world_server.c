@@ -7,9 +7,58 @@
 
 #include "world.h"
 #include "network.h"
+#include "grid.h"
+#include "scheduler.h"
+#include "update_template.h"
+#include "char_enum.h"
+#include "update_compress.h"
+#include "update_batch.h"
+#include "thread.h"
+#include "persistence.h"
 
 static server_t *g_world_server = NULL;
 
+/* Running session thread, tracked so shutdown can wait for it */
+typedef struct session_thread {
+    world_session_t *session;
+    struct session_thread *prev;
+    struct session_thread *next;
+} session_thread_t;
+
+static mutex_t g_sessions_lock;
+static cond_t g_sessions_done;
+static session_thread_t *g_sessions = NULL;  /* Sessions whose client is still open */
+static int g_session_threads = 0;            /* Threads that have not finished cleanup */
+
+static void session_unlink(session_thread_t *node) {
+    if (node->prev) node->prev->next = node->next;
+    else g_sessions = node->next;
+    if (node->next) node->next->prev = node->prev;
+}
+
+/* Per-connection session thread */
+static void world_session_thread(void *arg) {
+    session_thread_t *node = (session_thread_t*)arg;
+
+    /* Returns after the session has left its map thread */
+    world_session_handle(node->session);
+
+    /* Shutdown must not touch the client once it is freed */
+    mutex_lock(&g_sessions_lock);
+    session_unlink(node);
+    mutex_unlock(&g_sessions_lock);
+
+    world_session_free(node->session);
+    update_compress_thread_cleanup();
+    packet_pool_trim();
+    database_thread_release();
+
+    mutex_lock(&g_sessions_lock);
+    if (--g_session_threads == 0) cond_broadcast(&g_sessions_done);
+    mutex_unlock(&g_sessions_lock);
+    FREE(node);
+}
+
 /* Client handler callback */
 static void world_client_handler(client_t *client, void *userdata) {
     (void)userdata;
@@ -21,17 +70,151 @@ static void world_client_handler(client_t *client, void *userdata) {
         return;
     }
 
-    world_session_handle(session);
-    world_session_free(session);
+    session_thread_t *node = ALLOC(session_thread_t);
+    if (!node) {
+        LOG_ERROR("WorldServer", "Failed to track session thread");
+        world_session_free(session);
+        return;
+    }
+    node->session = session;
+    node->prev = NULL;
+
+    mutex_lock(&g_sessions_lock);
+    node->next = g_sessions;
+    if (g_sessions) g_sessions->prev = node;
+    g_sessions = node;
+    g_session_threads++;
+    mutex_unlock(&g_sessions_lock);
+
+    thread_t thread;
+    if (thread_create(&thread, world_session_thread, node) != OK) {
+        LOG_ERROR("WorldServer", "Failed to start session thread");
+        mutex_lock(&g_sessions_lock);
+        session_unlink(node);
+        g_session_threads--;
+        mutex_unlock(&g_sessions_lock);
+        FREE(node);
+        world_session_free(session);
+        return;
+    }
+    thread_detach(thread);
+}
+
+/* Disconnect every client and wait for the session threads to finish */
+static void world_sessions_stop(void) {
+    mutex_lock(&g_sessions_lock);
+    int count = g_session_threads;
+    for (session_thread_t *node = g_sessions; node; node = node->next) {
+        client_shutdown(node->session->client);
+    }
+    while (g_session_threads > 0) {
+        cond_wait(&g_sessions_done, &g_sessions_lock);
+    }
+    mutex_unlock(&g_sessions_lock);
+
+    if (count > 0) {
+        LOG_INFO("WorldServer", "Closed %d sessions", count);
+    }
+}
+
+/* Release what world_server_start set up after the grid */
+static void world_state_shutdown(void) {
+    cond_destroy(&g_sessions_done);
+    mutex_destroy(&g_sessions_lock);
+    world_session_cache_shutdown();
+    char_enum_shutdown();
+    update_template_shutdown();
+    grid_shutdown();
 }
 
 result_t world_server_start(void) {
+    result_t result = grid_init();
+    if (result != OK) {
+        return result;
+    }
+
+    update_template_init();
+    char_enum_init();
+    world_session_cache_init();
+    mutex_init(&g_sessions_lock);
+    cond_init(&g_sessions_done);
+
     g_world_server = server_create(WORLD_SERVER_PORT, "WorldServer");
     if (!g_world_server) {
+        world_state_shutdown();
         return ERR_MEMORY;
     }
 
-    return server_run(g_world_server, world_client_handler, NULL);
+    result = scheduler_start();
+    if (result != OK) {
+        LOG_ERROR("WorldServer", "Failed to start map threads");
+        server_t *server = g_world_server;
+        g_world_server = NULL;
+        server_free(server);
+        world_state_shutdown();
+        return result;
+    }
+
+    result = server_run(g_world_server, world_client_handler, NULL);
+
+    /* Session threads use the map threads, grid and caches until they exit */
+    world_sessions_stop();
+    scheduler_stop();
+
+    persistence_stats_t persist_stats;
+    persistence_get_stats(&persist_stats);
+    LOG_INFO("WorldServer", "Saves: %llu queued (%llu periodic), %llu clean slots skipped, %llu deferred",
+             (unsigned long long)persist_stats.saves, (unsigned long long)persist_stats.periodic,
+             (unsigned long long)persist_stats.clean_skipped, (unsigned long long)persist_stats.deferred);
+
+    relay_stats_t stats;
+    relay_get_stats(&stats);
+    LOG_INFO("WorldServer", "Relay: %llu packets (%llu bytes), %llu heartbeats throttled (%llu bytes saved)",
+             (unsigned long long)stats.packets_relayed, (unsigned long long)stats.bytes_relayed,
+             (unsigned long long)stats.heartbeats_dropped, (unsigned long long)stats.bytes_saved);
+
+    update_template_stats_t template_stats;
+    update_template_get_stats(&template_stats);
+    LOG_INFO("WorldServer", "Create templates: %llu built, %llu hits, %llu fallbacks",
+             (unsigned long long)template_stats.built, (unsigned long long)template_stats.hits,
+             (unsigned long long)template_stats.fallbacks);
+
+    char_enum_stats_t enum_stats;
+    char_enum_get_stats(&enum_stats);
+    LOG_INFO("WorldServer", "Char enums: %llu built, %llu hits, %llu invalidations, %llu evictions",
+             (unsigned long long)enum_stats.built, (unsigned long long)enum_stats.hits,
+             (unsigned long long)enum_stats.invalidations, (unsigned long long)enum_stats.evictions);
+
+    update_compress_stats_t compress_stats;
+    update_compress_get_stats(&compress_stats);
+    LOG_INFO("WorldServer", "Compression: %llu packets, %llu -> %llu bytes, %llu skipped, %llu us",
+             (unsigned long long)compress_stats.packets_compressed,
+             (unsigned long long)compress_stats.bytes_in, (unsigned long long)compress_stats.bytes_out,
+             (unsigned long long)compress_stats.packets_skipped,
+             (unsigned long long)compress_stats.compress_us);
+
+    update_batch_stats_t batch_stats;
+    update_batch_get_stats(&batch_stats);
+    LOG_INFO("WorldServer", "Update batches: %llu packets, %llu blocks, %llu split",
+             (unsigned long long)batch_stats.packets, (unsigned long long)batch_stats.blocks,
+             (unsigned long long)batch_stats.splits);
+
+    packet_alloc_stats_t alloc_stats;
+    packet_get_alloc_stats(&alloc_stats);
+    LOG_INFO("WorldServer", "Packet writers: %llu, %llu spilled to heap, %llu reallocs",
+             (unsigned long long)alloc_stats.writers, (unsigned long long)alloc_stats.heap_allocs,
+             (unsigned long long)alloc_stats.heap_reallocs);
+
+    packet_pool_stats_t pool_stats;
+    packet_pool_get_stats(&pool_stats);
+    uint64_t pool_requests = pool_stats.hits + pool_stats.misses;
+    LOG_INFO("WorldServer", "Buffer pools: %llu hits, %llu misses (%.1f%% hit rate), %llu discarded",
+             (unsigned long long)pool_stats.hits, (unsigned long long)pool_stats.misses,
+             pool_requests ? 100.0 * pool_stats.hits / pool_requests : 0.0,
+             (unsigned long long)pool_stats.discards);
+
+    world_state_shutdown();
+    return result;
 }
 
 void world_server_stop(void) {
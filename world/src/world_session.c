@@ -9,28 +9,102 @@
 #include "packet.h"
 #include "opcodes.h"
 #include "update.h"
+#include "update_template.h"
+#include "update_compress.h"
 #include "positions.h"
+#include "grid.h"
+#include "scheduler.h"
+#include "visibility.h"
+#include "slab.h"
+#include "persistence.h"
+#include "char_enum.h"
 #include <openssl/sha.h>
 
+/* Sessions per slab */
+#define WORLD_SESSION_SLAB_OBJECTS 16
+
+static slab_cache_t g_session_cache;
+
+void world_session_cache_init(void) {
+    slab_cache_init(&g_session_cache, "world_session_t", sizeof(world_session_t), WORLD_SESSION_SLAB_OBJECTS);
+}
+
+void world_session_cache_shutdown(void) {
+    slab_log_stats(&g_session_cache, "WorldServer");
+    slab_cache_destroy(&g_session_cache);
+}
+
+static result_t queue_update_sink(void *ctx, const uint8_t *data, size_t size) {
+    return world_session_queue_update((world_session_t*)ctx, data, size);
+}
+
 world_session_t *world_session_create(client_t *client) {
-    world_session_t *session = ALLOC(world_session_t);
+    world_session_t *session = (world_session_t*)slab_alloc(&g_session_cache);
     if (!session) return NULL;
 
     session->client = client;
     session->encryption_enabled = false;
     account_init(&session->account);
     session->has_player = false;
+    grid_object_init(&session->player.grid, session, 0);  /* Not in any map yet */
     session->state = WORLD_STATE_INIT;
     session->server_seed = (uint32_t)rand();
     session->time_sync_counter = 0;
 
+    if (writer_init(&session->send_buffer) != OK) {
+        slab_free(&g_session_cache, session);
+        return NULL;
+    }
+    if (update_batch_init(&session->update_batch, queue_update_sink, session) != OK) {
+        writer_free(&session->send_buffer);
+        slab_free(&g_session_cache, session);
+        return NULL;
+    }
+    mutex_init(&session->send_lock);
+    outbound_queue_init(&session->outbound);
+    session->flush_items = NULL;
+    session->flush_capacity = 0;
+
+    mutex_init(&session->handler_lock);
+    mutex_init(&session->inbound.lock);
+    session->inbound.items = NULL;
+    session->inbound.count = 0;
+    session->inbound.capacity = 0;
+    session->process_items = NULL;
+    session->process_capacity = 0;
+    session->in_map = false;
+    session->time_sync_timer = 0;
+    session->visible = NULL;
+    session->visible_count = 0;
+    arena_init(&session->arena, ARENA_BLOCK_SIZE);
+    session->recv_buffer = NULL;
+    session->recv_capacity = 0;
+
     return session;
 }
 
 void world_session_free(world_session_t *session) {
     if (!session) return;
+    if (session->state != WORLD_STATE_INIT) {
+        char_enum_session_end(session->account.id);
+    }
+    for (int i = 0; i < session->inbound.count; i++) {
+        free(session->inbound.items[i].data);
+    }
+    FREE(session->inbound.items);
+    FREE(session->process_items);
+    mutex_destroy(&session->inbound.lock);
+    mutex_destroy(&session->handler_lock);
+    visibility_free(session);
+    update_batch_free(&session->update_batch);
+    arena_free(&session->arena);
+    FREE(session->recv_buffer);
+    outbound_queue_free(&session->outbound);
+    mutex_destroy(&session->send_lock);
+    writer_free(&session->send_buffer);
+    FREE(session->flush_items);
     client_free(session->client);
-    free(session);
+    slab_free(&g_session_cache, session);
 }
 
 /* Opcode name for debugging */
@@ -51,40 +125,161 @@ static const char *opcode_name(uint16_t opcode) {
         case SMSG_INIT_WORLD_STATES: return "SMSG_INIT_WORLD_STATES";
         case SMSG_BINDPOINTUPDATE: return "SMSG_BINDPOINTUPDATE";
         case SMSG_UPDATE_OBJECT: return "SMSG_UPDATE_OBJECT";
+        case SMSG_COMPRESSED_UPDATE_OBJECT: return "SMSG_COMPRESSED_UPDATE_OBJECT";
         case SMSG_TIME_SYNC_REQ: return "SMSG_TIME_SYNC_REQ";
         case SMSG_PONG: return "SMSG_PONG";
         case SMSG_NAME_QUERY_RESPONSE: return "SMSG_NAME_QUERY_RESPONSE";
+        case SMSG_STANDSTATE_UPDATE: return "SMSG_STANDSTATE_UPDATE";
         default: return "UNKNOWN";
     }
 }
 
+/* Build (and encrypt) a server packet header, caller must hold send_lock.
+ * Returns the header length. */
+static size_t build_packet_header(world_session_t *session, uint16_t opcode,
+                                  size_t data_len, uint8_t header[SERVER_LARGE_HEADER_SIZE]) {
+    size_t size = data_len + 2;  /* +2 for opcode */
+    size_t header_len;
+
+    if (size > SERVER_PACKET_SMALL_MAX) {
+        /* Large packet: flagged 3-byte big-endian size + 2 bytes opcode */
+        header[0] = (uint8_t)(SERVER_LARGE_PACKET_FLAG | (size >> 16));
+        header[1] = (uint8_t)(size >> 8);
+        header[2] = (uint8_t)(size & 0xFF);
+        header[3] = (uint8_t)(opcode & 0xFF);
+        header[4] = (uint8_t)((opcode >> 8) & 0xFF);
+        header_len = SERVER_LARGE_HEADER_SIZE;
+    } else {
+        /* Header: 2 bytes size (big-endian) + 2 bytes opcode (little-endian) */
+        header[0] = (uint8_t)(size >> 8);
+        header[1] = (uint8_t)(size & 0xFF);
+        header[2] = (uint8_t)(opcode & 0xFF);
+        header[3] = (uint8_t)((opcode >> 8) & 0xFF);
+        header_len = SERVER_HEADER_SIZE;
+    }
+
+    /* Encrypt header if enabled (every header byte, the size flag included) */
+    if (session->encryption_enabled) {
+        worldcrypt_encrypt(&session->crypt, header, header_len);
+    }
+    return header_len;
+}
+
 /* Send packet with proper header format */
 static result_t send_packet(world_session_t *session, uint16_t opcode,
                                 const uint8_t *data, size_t data_len) {
     LOG_DEBUG("WorldServer", "SEND %s (0x%04X) size=%zu", opcode_name(opcode), opcode, data_len);
 
-    /* Header: 2 bytes size (big-endian) + 2 bytes opcode (little-endian) */
-    uint16_t size = (uint16_t)(data_len + 2);  /* +2 for opcode */
-    uint8_t header[4];
-    header[0] = (uint8_t)(size >> 8);
-    header[1] = (uint8_t)(size & 0xFF);
-    header[2] = (uint8_t)(opcode & 0xFF);
-    header[3] = (uint8_t)((opcode >> 8) & 0xFF);
+    if (data_len > SERVER_PACKET_MAX) return ERR_BUFFER_OVERFLOW;
 
-    /* Encrypt header if enabled */
-    if (session->encryption_enabled) {
-        worldcrypt_encrypt(&session->crypt, header, 4);
-    }
+    mutex_lock(&session->send_lock);
+
+    uint8_t header[SERVER_LARGE_HEADER_SIZE];
+    size_t header_len = build_packet_header(session, opcode, data_len, header);
 
     /* Send header */
-    result_t result = client_send_all(session->client, header, 4);
-    if (result != OK) return result;
+    result_t result = client_send_all(session->client, header, header_len);
 
     /* Send payload */
-    if (data_len > 0) {
+    if (result == OK && data_len > 0) {
         result = client_send_all(session->client, data, data_len);
     }
 
+    mutex_unlock(&session->send_lock);
+    return result;
+}
+
+/* Write out the flush buffer (caller holds send_lock) */
+static result_t send_buffered(world_session_t *session) {
+    if (!client_is_connected(session->client) || writer_size(&session->send_buffer) == 0) return OK;
+    return client_send_all(session->client, writer_data(&session->send_buffer),
+                           writer_size(&session->send_buffer));
+}
+
+result_t world_session_flush(world_session_t *session) {
+    /* This tick's update blocks go out as one packet ahead of the rest */
+    update_batch_flush(&session->update_batch);
+
+    int count = outbound_queue_take(&session->outbound, &session->flush_items, &session->flush_capacity);
+    if (count == 0) return OK;
+
+    result_t result = OK;
+
+    /* Concatenate every queued packet so the whole tick goes out in one write */
+    mutex_lock(&session->send_lock);
+    writer_reset(&session->send_buffer);
+    for (int i = 0; i < count; i++) {
+        shared_payload_t *payload = session->flush_items[i];
+        if (result == OK && payload->size <= SERVER_PACKET_MAX) {
+            /* Building a header advances the cipher, so make room first */
+            size_t needed = SERVER_LARGE_HEADER_SIZE + payload->size;
+            if (writer_size(&session->send_buffer) + needed > PACKET_MAX_SIZE) {
+                result = send_buffered(session);
+                writer_reset(&session->send_buffer);
+            }
+
+            uint8_t header[SERVER_LARGE_HEADER_SIZE];
+            if (result != OK) {
+                /* Connection is gone; drop the rest */
+            } else if (needed > PACKET_MAX_SIZE) {
+                /* Too large to buffer, send it on its own */
+                size_t header_len = build_packet_header(session, payload->opcode, payload->size, header);
+                result = client_send_all(session->client, header, header_len);
+                if (result == OK) {
+                    result = client_send_all(session->client, payload->data, payload->size);
+                }
+            } else {
+                size_t header_len = build_packet_header(session, payload->opcode, payload->size, header);
+                if (write_bytes(&session->send_buffer, header, header_len) != OK ||
+                    write_bytes(&session->send_buffer, payload->data, payload->size) != OK) {
+                    /* The client already expects this header; the stream can't recover */
+                    LOG_ERROR("WorldServer", "Out of memory flushing %s, disconnecting",
+                              opcode_name(payload->opcode));
+                    client_shutdown(session->client);
+                    result = ERR_MEMORY;
+                }
+            }
+        }
+        shared_payload_release(payload);
+    }
+    if (result == OK) {
+        result = send_buffered(session);
+    }
+    mutex_unlock(&session->send_lock);
+
+    return result;
+}
+
+/* Send an SMSG_UPDATE_OBJECT body, compressed when worthwhile */
+static result_t send_update_packet(world_session_t *session, const uint8_t *data, size_t size) {
+    packet_writer_t compressed;
+    if (writer_init(&compressed) != OK) return ERR_MEMORY;
+
+    result_t result;
+    if (update_compress(data, size, &compressed)) {
+        result = send_packet(session, SMSG_COMPRESSED_UPDATE_OBJECT,
+                             writer_data(&compressed), writer_size(&compressed));
+    } else {
+        result = send_packet(session, SMSG_UPDATE_OBJECT, data, size);
+    }
+
+    writer_free(&compressed);
+    return result;
+}
+
+result_t world_session_queue_update(world_session_t *session, const uint8_t *data, size_t size) {
+    packet_writer_t compressed;
+    if (writer_init(&compressed) != OK) return ERR_MEMORY;
+
+    result_t result;
+    if (update_compress(data, size, &compressed)) {
+        result = outbound_queue_push_data(&session->outbound, SMSG_COMPRESSED_UPDATE_OBJECT,
+                                          writer_data(&compressed), writer_size(&compressed));
+    } else {
+        result = outbound_queue_push_data(&session->outbound, SMSG_UPDATE_OBJECT, data, size);
+    }
+
+    writer_free(&compressed);
     return result;
 }
 
@@ -104,6 +299,12 @@ static result_t send_auth_challenge(world_session_t *session) {
 
 /* Handle CMSG_AUTH_SESSION (TBC 2.4.3 format) */
 static result_t handle_auth_session(world_session_t *session, const uint8_t *data, size_t len) {
+    /* Only once per connection; the account is fixed after that */
+    if (session->state != WORLD_STATE_INIT) {
+        LOG_ERROR("WorldServer", "Ignoring repeated auth session for account_id=%d", session->account.id);
+        return OK;
+    }
+
     packet_reader_t reader;
     reader_init(&reader, data, len);
 
@@ -174,60 +375,21 @@ static result_t handle_auth_session(world_session_t *session, const uint8_t *dat
     send_packet(session, SMSG_AUTH_RESPONSE, writer_data(&packet), writer_size(&packet));
     writer_free(&packet);
 
+    char_enum_session_start(session->account.id);
     session->state = WORLD_STATE_AUTHED;
     return OK;
 }
 
 /* Handle CMSG_CHAR_ENUM */
 static result_t handle_char_enum(world_session_t *session) {
-    character_list_t characters;
-    database_get_characters(session->account.id, &characters);
+    shared_payload_t *payload = char_enum_get(session->account.id, &session->arena);
+    if (!payload) return ERR_MEMORY;
 
     LOG_INFO("WorldServer", "Char enum for account_id=%d: found %d characters",
-             session->account.id, characters.count);
-
-    packet_writer_t packet;
-    writer_init(&packet);
-    write_uint8(&packet, (uint8_t)characters.count);
-
-    for (int i = 0; i < characters.count; i++) {
-        character_t *c = &characters.items[i];
-
-        write_uint64(&packet, (uint64_t)c->id);  /* GUID */
-        write_cstring(&packet, c->name);
-        write_uint8(&packet, c->race);
-        write_uint8(&packet, c->char_class);
-        write_uint8(&packet, c->gender);
-        write_uint8(&packet, c->skin);
-        write_uint8(&packet, c->face);
-        write_uint8(&packet, c->hair_style);
-        write_uint8(&packet, c->hair_color);
-        write_uint8(&packet, c->facial_hair);
-        write_uint8(&packet, c->level);
-        write_uint32(&packet, (uint32_t)c->map);  /* Zone ID (using map for simplicity) */
-        write_uint32(&packet, (uint32_t)c->map);  /* Map ID */
-        write_float(&packet, c->x);
-        write_float(&packet, c->y);
-        write_float(&packet, c->z);
-        write_uint32(&packet, 0);  /* Guild ID */
-
-        write_uint32(&packet, 0);  /* Character flags */
-        write_uint8(&packet, 1);   /* At login flags (1 = first login resting) */
-        write_uint32(&packet, 0);  /* Pet display ID */
-        write_uint32(&packet, 0);  /* Pet level */
-        write_uint32(&packet, 0);  /* Pet family */
-
-        /* Equipment (TBC: 20 slots = 19 equipment + 1 bag) */
-        for (int j = 0; j < 20; j++) {
-            write_uint32(&packet, 0);  /* Display ID */
-            write_uint8(&packet, 0);   /* Inventory type */
-            write_uint32(&packet, 0);  /* Enchant aura ID */
-        }
-    }
+             session->account.id, payload->data[0]);
 
-    send_packet(session, SMSG_CHAR_ENUM, writer_data(&packet), writer_size(&packet));
-    writer_free(&packet);
-    character_list_free(&characters);
+    send_packet(session, payload->opcode, payload->data, payload->size);
+    shared_payload_release(payload);
 
     session->state = WORLD_STATE_CHAR_SELECT;
     return OK;
@@ -294,6 +456,7 @@ static result_t handle_char_create(world_session_t *session, const uint8_t *data
         write_uint8(&packet, CHAR_CREATE_FAILED);
     } else {
         LOG_INFO("WorldServer", "Character created: %s", name);
+        char_enum_invalidate(session->account.id);
         write_uint8(&packet, CHAR_CREATE_SUCCESS);
     }
 
@@ -308,11 +471,22 @@ static result_t handle_char_delete(world_session_t *session, const uint8_t *data
     reader_init(&reader, data, len);
     uint64_t guid = read_uint64(&reader);
 
-    database_delete_character((int)guid);
+    /* Only the owning account may delete a character */
+    uint8_t response = CHAR_DELETE_FAILED;
+    character_t character;
+    if (database_get_character((int)guid, &character) != OK) {
+        LOG_ERROR("WorldServer", "Character delete: no character %llu", (unsigned long long)guid);
+    } else if (character.account_id != session->account.id) {
+        LOG_ERROR("WorldServer", "Character delete: account_id=%d does not own %s",
+                  session->account.id, character.name);
+    } else if (database_delete_character(character.id) == OK) {
+        char_enum_invalidate(character.account_id);
+        response = CHAR_DELETE_SUCCESS;
+    }
 
     packet_writer_t packet;
     writer_init(&packet);
-    write_uint8(&packet, CHAR_DELETE_SUCCESS);
+    write_uint8(&packet, response);
     send_packet(session, SMSG_CHAR_DELETE, writer_data(&packet), writer_size(&packet));
     writer_free(&packet);
     return OK;
@@ -415,27 +589,23 @@ static result_t send_initialize_factions(world_session_t *session) {
 }
 
 static result_t send_update_object(world_session_t *session) {
-    update_builder_t builder;
-    update_builder_init(&builder);
-
     packet_writer_t packet;
     writer_init(&packet);
 
-    update_build_create_packet(&builder, &session->player, true, &packet);
+    update_template_build_create(&session->player, true, &packet);
 
     /* Hex dump full update packet for debugging */
     size_t total_size = writer_size(&packet);
-    char *hex = (char*)malloc(total_size * 3 + 1);
-    hex[0] = '\0';
-    for (size_t i = 0; i < total_size; i++) {
-        char byte_str[4];
-        snprintf(byte_str, sizeof(byte_str), "%02X ", writer_data(&packet)[i]);
-        strcat(hex, byte_str);
+    char *hex = (char*)arena_alloc(&session->arena, total_size * 3 + 1);
+    if (hex) {
+        for (size_t i = 0; i < total_size; i++) {
+            snprintf(hex + i * 3, 4, "%02X ", writer_data(&packet)[i]);
+        }
+        hex[total_size * 3] = '\0';
+        LOG_DEBUG("WorldServer", "UPDATE_OBJECT total=%zu hex: %s", total_size, hex);
     }
-    LOG_DEBUG("WorldServer", "UPDATE_OBJECT total=%zu hex: %s", total_size, hex);
-    free(hex);
 
-    send_packet(session, SMSG_UPDATE_OBJECT, writer_data(&packet), writer_size(&packet));
+    send_update_packet(session, writer_data(&packet), writer_size(&packet));
     writer_free(&packet);
     return OK;
 }
@@ -488,6 +658,12 @@ static result_t handle_player_login(world_session_t *session, const uint8_t *dat
     reader_init(&reader, data, len);
     uint64_t guid = read_uint64(&reader);
 
+    /* Already in world (a second login without logging out) */
+    if (session->state == WORLD_STATE_IN_WORLD) {
+        LOG_ERROR("WorldServer", "Ignoring login while in world: %s", session->player.character.name);
+        return ERR_ALREADY_EXISTS;
+    }
+
     character_t character;
     result_t result = database_get_character((int)guid, &character);
     if (result != OK) {
@@ -496,8 +672,15 @@ static result_t handle_player_login(world_session_t *session, const uint8_t *dat
     }
 
     player_init(&session->player, &character);
+    session->player.grid.owner = session;
     session->has_player = true;
 
+    result = grid_add(&session->player.grid, session->player.map,
+                      session->player.x, session->player.y, session->player.z);
+    if (result != OK) {
+        LOG_ERROR("WorldServer", "Map %d has no grid, player will not be visible", session->player.map);
+    }
+
     LOG_INFO("WorldServer", "Player login: %s (guid=%llu map=%d pos=%.1f,%.1f,%.1f)",
              character.name, (unsigned long long)session->player.guid,
              session->player.map, session->player.x, session->player.y, session->player.z);
@@ -543,8 +726,8 @@ static result_t handle_name_query(world_session_t *session, const uint8_t *data,
     reader_init(&reader, data, len);
     uint64_t guid = read_uint64(&reader);
 
-    character_t character;
-    result_t result = database_get_character((int)guid, &character);
+    character_name_t character;
+    result_t result = database_get_character_name((int)guid, &character);
 
     packet_writer_t packet;
     writer_init(&packet);
@@ -571,6 +754,9 @@ static result_t handle_name_query(world_session_t *session, const uint8_t *data,
 
 /* Handle CMSG_LOGOUT_REQUEST */
 static result_t handle_logout_request(world_session_t *session) {
+    /* Nothing to log out of from the character screen */
+    if (session->state != WORLD_STATE_IN_WORLD) return OK;
+
     packet_writer_t packet;
     writer_init(&packet);
     write_uint32(&packet, 0);  /* Reason (0 = success) */
@@ -584,15 +770,91 @@ static result_t handle_logout_request(world_session_t *session) {
     send_packet(session, SMSG_LOGOUT_COMPLETE, writer_data(&complete), writer_size(&complete));
     writer_free(&complete);
 
+    grid_remove(&session->player.grid);
     session->state = WORLD_STATE_CHAR_SELECT;
     session->has_player = false;
     return OK;
 }
 
+/* Handle CMSG_STANDSTATECHANGE */
+static result_t handle_stand_state_change(world_session_t *session, const uint8_t *data, size_t len) {
+    if (!session->has_player) return OK;
+
+    packet_reader_t reader;
+    reader_init(&reader, data, len);
+    uint32_t state = read_uint32(&reader);
+
+    /* Only the states a client can pick itself */
+    switch (state) {
+        case UNIT_STAND_STATE_STAND:
+        case UNIT_STAND_STATE_SIT:
+        case UNIT_STAND_STATE_SLEEP:
+        case UNIT_STAND_STATE_KNEEL:
+            break;
+        default:
+            return ERR_INVALID_PARAM;
+    }
+
+    /* Observers get the change with the next values update */
+    player_set_stand_state(&session->player, (uint8_t)state);
+
+    packet_writer_t packet;
+    writer_init(&packet);
+    write_uint8(&packet, (uint8_t)state);
+    send_packet(session, SMSG_STANDSTATE_UPDATE, writer_data(&packet), writer_size(&packet));
+    writer_free(&packet);
+    return OK;
+}
+
+/* Grid visitor: hand a values block to every observer that has the object */
+typedef struct {
+    const grid_object_t *source;
+    const uint8_t *block;
+    size_t size;
+} values_ctx_t;
+
+static void values_visitor(grid_object_t *object, float dist_sq, void *ctx) {
+    (void)dist_sq;
+    values_ctx_t *values = (values_ctx_t*)ctx;
+    if (object == values->source || !object->owner) return;
+
+    /* Observers without a create block yet get current values with it */
+    world_session_t *observer = (world_session_t*)object->owner;
+    if (!visibility_contains(observer, values->source->guid)) return;
+
+    update_batch_add_block(&observer->update_batch, values->block, values->size);
+}
+
+/* Send changed fields to the player and everyone who can see them */
+static void send_values_update(world_session_t *session) {
+    if (!session->has_player || !session->player.fields.dirty) return;
+
+    /* Serialized once, appended to every observer's batch */
+    packet_writer_t block;
+    writer_init(&block);
+
+    if (update_write_values_block(&session->player, &block) == OK) {
+        update_batch_add_block(&session->update_batch, writer_data(&block), writer_size(&block));
+
+        grid_object_t *self = &session->player.grid;
+        if (self->map_index >= 0) {
+            values_ctx_t ctx = { self, writer_data(&block), writer_size(&block) };
+            grid_visit(self->map, self->x, self->y, WORLD_VISIBILITY_DISTANCE, values_visitor, &ctx);
+        }
+    }
+
+    writer_free(&block);
+    field_store_clear_dirty(&session->player.fields);
+}
+
 /* Handle movement packets (TBC format) */
 static void handle_movement(world_session_t *session, uint16_t opcode, const uint8_t *data, size_t len) {
-    (void)opcode;
     if (!session->has_player || len < 28) return;
+    if (!relay_validate_movement(data, len)) {
+        LOG_ERROR("WorldServer", "Invalid movement packet 0x%04X from %s",
+                  opcode, session->player.character.name);
+        return;
+    }
 
     packet_reader_t reader;
     reader_init(&reader, data, len);
@@ -602,24 +864,38 @@ static void handle_movement(world_session_t *session, uint16_t opcode, const uin
      * uint8_t  move_flags2 (TBC addition)
      * uint32_t time
      * float x, y, z, orientation
+     * (length checked above, so the reads below go unchecked)
      */
-    /* uint32_t move_flags = */ read_uint32(&reader);
-    /* uint8_t move_flags2 = */ read_uint8(&reader);
-    /* uint32_t time = */ read_uint32(&reader);
-    float x = read_float(&reader);
-    float y = read_float(&reader);
-    float z = read_float(&reader);
-    float orientation = read_float(&reader);
+    /* uint32_t move_flags = */ read_uint32_unchecked(&reader);
+    /* uint8_t move_flags2 = */ read_uint8_unchecked(&reader);
+    /* uint32_t time = */ read_uint32_unchecked(&reader);
+    float x = read_float_unchecked(&reader);
+    float y = read_float_unchecked(&reader);
+    float z = read_float_unchecked(&reader);
+    float orientation = read_float_unchecked(&reader);
 
     /* Update player position */
     session->player.x = x;
     session->player.y = y;
     session->player.z = z;
     session->player.orientation = orientation;
+
+    session->player.save_dirty = true;
+
+    /* Rebucket into the spatial grid (cell change is an O(1) relink) */
+    grid_move(&session->player.grid, x, y, z);
+
+    /* Forward to everyone who can see us */
+    if (relay_is_movement_opcode(opcode)) {
+        if (opcode == MSG_MOVE_HEARTBEAT) {
+            session->player.heartbeat_count++;
+        }
+        relay_movement(&session->player.grid, opcode, session->player.heartbeat_count, data, len);
+    }
 }
 
-/* Handle a single packet */
-static result_t handle_packet(world_session_t *session, uint16_t opcode, const uint8_t *data, size_t len) {
+/* Dispatch a single packet to its handler */
+static result_t dispatch_packet(world_session_t *session, uint16_t opcode, const uint8_t *data, size_t len) {
     switch (opcode) {
         case CMSG_AUTH_SESSION:
             return handle_auth_session(session, data, len);
@@ -648,8 +924,9 @@ static result_t handle_packet(world_session_t *session, uint16_t opcode, const u
             writer_free(&pkt);
             return OK;
         }
-        case CMSG_TIME_SYNC_RESP:
         case CMSG_STANDSTATECHANGE:
+            return handle_stand_state_change(session, data, len);
+        case CMSG_TIME_SYNC_RESP:
         case CMSG_SET_SELECTION:
             /* Silently ignore */
             return OK;
@@ -663,6 +940,123 @@ static result_t handle_packet(world_session_t *session, uint16_t opcode, const u
     }
 }
 
+/* Handle a single packet, caller must hold handler_lock. Whatever the
+ * handler took from the session arena is released in one go afterwards. */
+static void handle_packet(world_session_t *session, uint16_t opcode, const uint8_t *data, size_t len) {
+    dispatch_packet(session, opcode, data, len);
+    arena_reset(&session->arena);
+}
+
+/* Queue a copy of a packet for the map thread, returns false if the session
+ * is not in a map (the caller then handles it itself) */
+static bool world_session_queue_packet(world_session_t *session, uint16_t opcode,
+                                       const uint8_t *payload, size_t size) {
+    packet_queue_t *queue = &session->inbound;
+    bool queued = false;
+
+    mutex_lock(&queue->lock);
+    if (session->in_map) {
+        queued = true;
+        uint8_t *data = NULL;
+        if (size > 0) {
+            data = (uint8_t*)malloc(size);
+            if (data) memcpy(data, payload, size);
+        }
+        if (queue->count >= queue->capacity) {
+            int new_capacity = queue->capacity == 0 ? 16 : queue->capacity * 2;
+            queued_packet_t *new_items = (queued_packet_t*)realloc(
+                queue->items, new_capacity * sizeof(queued_packet_t));
+            if (new_items) {
+                queue->items = new_items;
+                queue->capacity = new_capacity;
+            }
+        }
+        if (queue->count < queue->capacity && (data || size == 0)) {
+            queued_packet_t *item = &queue->items[queue->count++];
+            item->opcode = opcode;
+            item->data = data;
+            item->size = size;
+        } else {
+            LOG_ERROR("WorldServer", "Dropping packet 0x%04X, out of memory", opcode);
+            free(data);
+        }
+    }
+    mutex_unlock(&queue->lock);
+
+    return queued;
+}
+
+/* Handle everything queued so far, caller must hold handler_lock */
+static void world_session_process_queue(world_session_t *session) {
+    packet_queue_t *queue = &session->inbound;
+
+    /* Swap arrays so the I/O thread can keep queueing while we handle */
+    mutex_lock(&queue->lock);
+    queued_packet_t *items = queue->items;
+    int count = queue->count;
+    int capacity = queue->capacity;
+    queue->items = session->process_items;
+    queue->capacity = session->process_capacity;
+    queue->count = 0;
+    mutex_unlock(&queue->lock);
+
+    session->process_items = items;
+    session->process_capacity = capacity;
+
+    for (int i = 0; i < count; i++) {
+        handle_packet(session, items[i].opcode, items[i].data, items[i].size);
+        free(items[i].data);
+    }
+}
+
+void world_session_update(world_session_t *session, uint32_t diff) {
+    mutex_lock(&session->handler_lock);
+
+    world_session_process_queue(session);
+
+    if (session->state == WORLD_STATE_IN_WORLD) {
+        session->time_sync_timer += diff;
+        if (session->time_sync_timer >= TIME_SYNC_INTERVAL_MS) {
+            session->time_sync_timer = 0;
+            send_time_sync_request(session);
+        }
+    }
+
+    send_values_update(session);
+
+    mutex_unlock(&session->handler_lock);
+}
+
+void world_session_enter_map(world_session_t *session) {
+    mutex_lock(&session->inbound.lock);
+    session->in_map = true;
+    session->time_sync_timer = 0;
+    mutex_unlock(&session->inbound.lock);
+
+    persistence_schedule(&session->player);
+}
+
+void world_session_leave_map(world_session_t *session) {
+    mutex_lock(&session->handler_lock);
+
+    mutex_lock(&session->inbound.lock);
+    session->in_map = false;
+    mutex_unlock(&session->inbound.lock);
+
+    grid_remove(&session->player.grid);
+    visibility_clear(session);
+    update_batch_reset(&session->update_batch);
+
+    /* Logout save; the character screen shows the new position */
+    persistence_save(&session->player);
+    char_enum_invalidate(session->account.id);
+
+    /* Packets queued after the logout still need an answer */
+    world_session_process_queue(session);
+
+    mutex_unlock(&session->handler_lock);
+}
+
 void world_session_handle(world_session_t *session) {
     LOG_INFO("WorldServer", "Client connected: %s", client_get_address(session->client));
 
@@ -689,37 +1083,51 @@ void world_session_handle(world_session_t *session) {
         /* Size includes opcode bytes, so subtract 4 */
         size_t payload_size = size > 4 ? size - 4 : 0;
 
-        /* Read payload */
-        uint8_t *payload = NULL;
+        /* Read payload into the reused receive buffer */
+        if (payload_size > session->recv_capacity) {
+            uint8_t *buffer = (uint8_t*)realloc(session->recv_buffer, payload_size);
+            if (!buffer) break;
+            session->recv_buffer = buffer;
+            session->recv_capacity = payload_size;
+        }
+        const uint8_t *payload = session->recv_buffer;
         if (payload_size > 0) {
-            payload = (uint8_t*)malloc(payload_size);
-            if (!payload) break;
-
-            result = client_recv_exact(session->client, payload, payload_size);
-            if (result != OK) {
-                free(payload);
-                break;
-            }
+            result = client_recv_exact(session->client, session->recv_buffer, payload_size);
+            if (result != OK) break;
         }
 
         /* Log every received opcode */
         LOG_DEBUG("WorldServer", "RECV opcode=0x%04X size=%zu", opcode, payload_size);
 
-        /* Handle packet */
+        /* In world, the map thread handles packets on its next tick */
+        if (world_session_queue_packet(session, opcode, payload, payload_size)) {
+            continue;
+        }
+
+        mutex_lock(&session->handler_lock);
         handle_packet(session, opcode, payload, payload_size);
-        free(payload);
+        mutex_unlock(&session->handler_lock);
+
+        /* Hand the session to its map thread once it has entered the world */
+        if (session->state == WORLD_STATE_IN_WORLD && !session->in_map) {
+            result = scheduler_add_session(session);
+            if (result != OK) {
+                /* Nothing would tick, flush or save it; drop the connection */
+                LOG_ERROR("WorldServer", "No map thread for guid %llu on map %d (%d), disconnecting",
+                          (unsigned long long)session->player.guid, session->player.map, result);
+                break;
+            }
+        }
+    }
+
+    /* Leave the map before saving, so no tick touches the player afterwards */
+    if (session->has_player || session->in_map) {
+        scheduler_remove_session(session);
     }
 
-    /* Save position on disconnect */
+    /* Save whatever changed since the last periodic save */
     if (session->has_player) {
-        database_update_character_position(
-            session->player.character.id,
-            session->player.map,
-            session->player.x,
-            session->player.y,
-            session->player.z,
-            session->player.orientation
-        );
+        persistence_save(&session->player);
     }
 
     LOG_INFO("WorldServer", "Client disconnected: %s", client_get_address(session->client));